@@ -0,0 +1,114 @@
+#ifndef __ALL_PAIRS_H__
+#define __ALL_PAIRS_H__
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "types.h"
+
+/**
+ * AllPairsResult: all-pairs shortest paths stored as a contiguous n x n
+ * distance matrix plus an n x n predecessor matrix, from which any path is
+ * rebuilt on demand (instead of keeping n^2 path vectors). The distance type D
+ * may be double (default), float or unsigned int to halve the matrix; pairs
+ * with no path hold AllPairsResult<D>::infinity(). unsigned int truncates
+ * fractional distances and holds no negative ones: johnson() and
+ * floyd_warshall() refuse graphs with negative weights for it, and set_row()
+ * stores 0 for any negative distance given.
+ */
+template <class D = double>
+class AllPairsResult
+{
+public:
+    // constructor: matrices for vertices 1..num_vertices
+    AllPairsResult(unsigned long num_vertices)
+    : dist((size_t) num_vertices * num_vertices, infinity()),
+      pred((size_t) num_vertices * num_vertices, 0)
+    {
+        vertex_count = num_vertices;
+    }
+
+    static D infinity()
+    {
+        return std::numeric_limits<D>::max();
+    }
+
+    unsigned long get_vertex_count() const
+    {
+        return vertex_count;
+    }
+
+    D distance(unsigned long u, unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        return dist[index(u, v)];
+    }
+
+    bool is_reachable(unsigned long u, unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        return dist[index(u, v)] != infinity();
+    }
+
+    /* predecessor of v in the shortest path from u (0 if u == v or unreachable) */
+    unsigned long predecessor(unsigned long u, unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        return pred[index(u, v)];
+    }
+
+    /* path from u to v, both included (empty if v is unreachable) */
+    void path(unsigned long u, unsigned long v, std::vector<unsigned long> *p) const
+    throw (NoSuchVertexException)
+    {
+        p->clear();
+        if (!is_reachable(u, v))
+            return;
+
+        const unsigned int *row = &pred[index(u, 1)];
+        for (unsigned long x = v; x != u; x = row[x-1])
+            p->push_back(x);
+        p->push_back(u);
+
+        std::reverse(p->begin(), p->end());
+    }
+
+    /* stores the row of 'source': distances (DBL_MAX if unreachable) and
+     * predecessors of every vertex, both indexed 1..n
+     */
+    void set_row(unsigned long source, const double *d, const unsigned long *p)
+    throw (NoSuchVertexException)
+    {
+        D *dist_row = &dist[index(source, 1)];
+        unsigned int *pred_row = &pred[index(source, 1)];
+
+        for (unsigned long v = 1; v<=vertex_count; ++v)
+        {
+            if (d[v] >= (double) infinity())
+                dist_row[v-1] = infinity();
+            else if (d[v] < 0 && !std::numeric_limits<D>::is_signed)
+                dist_row[v-1] = 0;   // out of range of D
+            else
+                dist_row[v-1] = (D) d[v];
+            pred_row[v-1] = p[v];
+        }
+    }
+
+private:
+    size_t index(unsigned long u, unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        if (u < 1 || u > vertex_count)
+            throw NoSuchVertexException(u);
+        if (v < 1 || v > vertex_count)
+            throw NoSuchVertexException(v);
+
+        return (size_t) (u-1) * vertex_count + (v-1);
+    }
+
+    unsigned long vertex_count;
+    std::vector<D> dist;
+    std::vector<unsigned int> pred;   // vertex keys fit 32 bits
+};
+
+#endif /* __ALL_PAIRS_H__ */
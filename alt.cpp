@@ -0,0 +1,234 @@
+#include "alt.h"
+#include "paths.h"
+#include <omp.h>
+#include <cfloat>   // for DBL_MAX
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+using namespace std;
+
+/* ALT lower bound of d(v,t) from the tables of the first 'count' landmarks;
+ * DBL_MAX when they prove that v cannot reach t
+ */
+static double landmark_bound(const double *v_from, const double *v_to,
+    const double *t_from, const double *t_to, ulong count)
+{
+    double h = 0;
+
+    for (ulong i = 0; i<count; ++i)
+    {
+        // d(L,t) - d(L,v): if L reaches v but not t, neither does v
+        if (t_from[i] < DBL_MAX)
+        {
+            if (v_from[i] < DBL_MAX)
+                h = max(h, t_from[i] - v_from[i]);
+        }
+        else if (v_from[i] < DBL_MAX)
+            return DBL_MAX;
+
+        // d(v,L) - d(t,L): if t reaches L but v does not, v cannot reach t
+        if (t_to[i] < DBL_MAX)
+        {
+            if (v_to[i] < DBL_MAX)
+                h = max(h, v_to[i] - t_to[i]);
+            else
+                return DBL_MAX;
+        }
+    }
+
+    return h;
+}
+
+/* farthest selection: vertex maximizing the round-trip distance to its
+ * closest landmark (unreachable vertices first)
+ */
+static ulong farthest_vertex(const vector<double> &from, const vector<double> &to,
+    ulong stride, ulong count, ulong num_vertices, const vector<bool> &is_landmark)
+{
+    ulong farthest = 0;
+    double max_dist = -1;
+
+    for (ulong v = 1; v<=num_vertices; ++v)
+    {
+        if (is_landmark[v])
+            continue;
+
+        double closest = DBL_MAX;
+        for (ulong i = 0; i<count; ++i)
+        {
+            double f = from[v*stride + i];
+            double t = to[v*stride + i];
+            closest = min(closest, (f < DBL_MAX && t < DBL_MAX) ? f + t : DBL_MAX);
+        }
+
+        if (closest > max_dist)
+        {
+            max_dist = closest;
+            farthest = v;
+        }
+    }
+
+    return farthest;
+}
+
+/* avoid selection (Goldberg & Werneck 2005): in a shortest path tree from
+ * 'root', weigh each vertex by how much the current landmarks underestimate
+ * its distance, and descend from the root into the heaviest subtrees without
+ * landmarks; the leaf reached is the new landmark (0 if there is none)
+ */
+static ulong avoid_vertex(AdjacencyList<> *graph, ulong root, sssp_workspace *ws,
+    const vector<double> &from, const vector<double> &to, ulong stride, ulong count,
+    const vector<bool> &is_landmark)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    dijkstra(graph, root, ws);
+
+    const vector<ulong> &tree = ws->get_settled();
+    vector<double> size(num_vertices+1, 0);
+    vector<ulong> heaviest_child(num_vertices+1, 0);
+    vector<bool> has_landmark(num_vertices+1, false);
+
+    // subtree sizes, children (settled later) first
+    for (ulong i = tree.size(); i-- > 0; )
+    {
+        ulong v = tree[i];
+
+        if (is_landmark[v] || has_landmark[v])
+        {
+            has_landmark[v] = true;
+            size[v] = 0;
+        }
+        else
+        {
+            double bound = landmark_bound(&from[root*stride], &to[root*stride],
+                &from[v*stride], &to[v*stride], count);
+            size[v] += ws->get_distance(v) - bound;
+        }
+
+        ulong parent = ws->get_predecessor(v);
+        if (parent != 0)
+        {
+            if (has_landmark[v])
+                has_landmark[parent] = true;
+
+            size[parent] += size[v];
+            if (heaviest_child[parent] == 0 || size[v] > size[heaviest_child[parent]])
+                heaviest_child[parent] = v;
+        }
+    }
+
+    if (has_landmark[root] && size[root] <= 0)
+        return 0;
+
+    ulong v = root;
+    while (heaviest_child[v] != 0 && size[heaviest_child[v]] > 0)
+        v = heaviest_child[v];
+
+    return is_landmark[v] ? 0 : v;
+}
+
+/*
+ * Landmark heuristic implementation
+ */
+
+landmark_heuristic::landmark_heuristic(AdjacencyList<> *graph, ulong num_landmarks, int selection)
+{
+    long num_vertices = graph->get_vertex_count();
+
+    // openmp setup
+    if ( !magical_config::load_settings("alt", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    vertex_count = num_vertices;
+    max_landmarks = min(num_landmarks, (ulong) num_vertices);
+    from.assign((num_vertices+1) * max_landmarks, DBL_MAX);
+    to.assign((num_vertices+1) * max_landmarks, DBL_MAX);
+    target_from.assign(max_landmarks, DBL_MAX);
+    target_to.assign(max_landmarks, DBL_MAX);
+
+    if (max_landmarks == 0)
+        return;
+
+    // distances toward a landmark: single-source searches on the transpose
+    AdjacencyList<> *reverse = transpose(graph);
+    sssp_workspace forward_ws(num_vertices), backward_ws(num_vertices), tree_ws(num_vertices);
+    vector<bool> is_landmark(num_vertices+1, false);
+    ulong seed = 1;
+
+    while (landmarks.size() < max_landmarks)
+    {
+        ulong count = landmarks.size();
+        ulong candidate = 0;
+
+        if (count == 0)
+        {
+            // the first landmark is the vertex farthest from an arbitrary one
+            dijkstra(graph, 1, &tree_ws);
+            candidate = tree_ws.get_settled().back();
+        }
+        else if (selection == ALT_AVOID)
+        {
+            // pseudo-random roots (linear congruential), for reproducible results
+            seed = (seed * 1103515245 + 12345) % 2147483648UL;
+            ulong root = (seed % num_vertices) + 1;
+
+            candidate = avoid_vertex(graph, root, &tree_ws, from, to, max_landmarks, count, is_landmark);
+        }
+
+        if (candidate == 0)
+            candidate = farthest_vertex(from, to, max_landmarks, count, num_vertices, is_landmark);
+
+        landmarks.push_back(candidate);
+        is_landmark[candidate] = true;
+
+        // distance tables of the new landmark: both directions at once
+        #pragma omp parallel sections default(none) shared(graph, reverse, candidate, forward_ws, backward_ws)
+        {
+            #pragma omp section
+            dijkstra(graph, candidate, &forward_ws);
+
+            #pragma omp section
+            dijkstra(reverse, candidate, &backward_ws);
+        }
+
+        #pragma omp parallel for default(none) shared(num_vertices, count, forward_ws, backward_ws) schedule(static)
+        for (long v = 1; v <= num_vertices; ++v)
+        {
+            from[v*max_landmarks + count] = forward_ws.get_distance(v);
+            to[v*max_landmarks + count] = backward_ws.get_distance(v);
+        }
+    }
+
+    delete reverse;
+}
+
+void landmark_heuristic::set_target(ulong t)
+{
+    if (t < 1 || t > vertex_count)
+        throw NoSuchVertexException(t);
+
+    for (ulong i = 0; i<landmarks.size(); ++i)
+    {
+        target_from[i] = from[t*max_landmarks + i];
+        target_to[i] = to[t*max_landmarks + i];
+    }
+}
+
+double landmark_heuristic::estimate(ulong v) const
+{
+    if (landmarks.empty())
+        return 0;
+
+    return landmark_bound(&from[v*max_landmarks], &to[v*max_landmarks],
+        &target_from[0], &target_to[0], landmarks.size());
+}
+
+const vector<ulong>& landmark_heuristic::get_landmarks() const { return landmarks; }
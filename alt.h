@@ -0,0 +1,44 @@
+#ifndef __ALT_H__
+#define __ALT_H__
+
+#include <vector>
+#include "types.h"
+#include "astar.h"
+
+// landmark selection strategies
+#define ALT_FARTHEST 0   // each landmark as far as possible from the previous ones
+#define ALT_AVOID    1   // landmarks in regions the current ones bound poorly
+
+/**
+ * landmark_heuristic: ALT lower bounds (A*, Landmarks and Triangle inequality;
+ * Goldberg & Harrelson 2005) for graphs without coordinates. Distances from
+ * and to a few landmarks are precomputed; by the triangle inequality,
+ *     d(v,t) >= max( d(L,t) - d(L,v), d(v,L) - d(t,L) )
+ * for every landmark L, giving a consistent heuristic for astar().
+ *
+ * Memory is 2 * landmarks * n distances. set_target() keeps per-query state,
+ * so concurrent queries need their own copies of the heuristic.
+ */
+class landmark_heuristic : public astar_heuristic
+{
+public:
+    landmark_heuristic(AdjacencyList<>*, unsigned long, int = ALT_AVOID);
+
+    void set_target(unsigned long);
+    double estimate(unsigned long) const;
+
+    const std::vector<unsigned long>& get_landmarks() const;
+
+private:
+    unsigned long vertex_count;
+    unsigned long max_landmarks;   // stride of the distance tables
+    std::vector<unsigned long> landmarks;
+
+    // d(L,v) and d(v,L), stored per vertex: [v*max_landmarks + i]
+    std::vector<double> from, to;
+
+    // distances of the current target
+    std::vector<double> target_from, target_to;
+};
+
+#endif /* __ALT_H__ */
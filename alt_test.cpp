@@ -0,0 +1,117 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "types.h"
+#include "paths.h"
+#include "astar.h"
+#include "alt.h"
+
+#include <sys/time.h>       // for 'gettimeofday()'
+
+#define NUM_QUERIES 200
+#define NUM_LANDMARKS 8
+
+using namespace std;
+
+// -- time evaluation functions ------------------------------------------------
+
+double wall_time()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1.e-6 * t.tv_usec;
+}
+
+// -----------------------------------------------------------------------------
+
+// road-like instance: side x side grid, with one-way streets now and then
+AdjacencyList<>* gridGraph(unsigned long side, unsigned long range)
+{
+    AdjacencyList<> *grid = new AdjacencyList<>(side*side);
+
+    srand(1234567);
+
+    for (unsigned long r = 0; r<side; ++r)
+    {
+        for (unsigned long c = 0; c<side; ++c)
+        {
+            unsigned long v = r*side + c + 1;
+            if (c+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v, v+1, w);
+                if (rand() % 10)
+                    grid->addEdge(v+1, v, w);
+            }
+            if (r+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v+side, v, w);
+                if (rand() % 10)
+                    grid->addEdge(v, v+side, w);
+            }
+        }
+    }
+
+    return grid;
+}
+
+int run_queries(AdjacencyList<> *graph, astar_heuristic *h, const char *name)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    sssp_workspace ws(num_vertices);
+    double dijkstra_time = 0, alt_time = 0;
+    int mismatches = 0;
+
+    srand(7654321);
+    for (int q = 0; q < NUM_QUERIES; ++q)
+    {
+        unsigned long s = (rand() % num_vertices) + 1;
+        unsigned long t = (rand() % num_vertices) + 1;
+
+        vector<unsigned long> targets(1, t);
+        double start = wall_time();
+        dijkstra_to_targets(graph, s, targets, &ws);
+        dijkstra_time += wall_time() - start;
+
+        vector<unsigned long> path;
+        start = wall_time();
+        double d = astar(graph, s, t, &path, h);
+        alt_time += wall_time() - start;
+
+        if (d != ws.get_distance(t))
+        {
+            cout << "mismatch " << s << " -> " << t << ": alt " << d
+                << " dijkstra " << ws.get_distance(t) << endl;
+            ++mismatches;
+        }
+    }
+
+    printf("%s\tdijkstra: %.6f\talt: %.6f\t%d mismatches\n", name, dijkstra_time, alt_time, mismatches);
+    return mismatches;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    unsigned long side = (argc > 1) ? atol(argv[1]) : 100;
+    AdjacencyList<> *graph = gridGraph(side, 100);
+    int errors = 0;
+
+    double start = wall_time();
+    landmark_heuristic farthest(graph, NUM_LANDMARKS, ALT_FARTHEST);
+    printf("farthest selection: %.6f\n", wall_time() - start);
+
+    start = wall_time();
+    landmark_heuristic avoid(graph, NUM_LANDMARKS, ALT_AVOID);
+    printf("avoid selection:    %.6f\n", wall_time() - start);
+
+    errors += run_queries(graph, &farthest, "farthest");
+    errors += run_queries(graph, &avoid, "avoid");
+
+    delete graph;
+
+    return errors;
+}
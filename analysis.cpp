@@ -0,0 +1,314 @@
+#include "analysis.h"
+#include "heap.h"
+#include "paths.h"
+#include <omp.h>
+#include <cfloat>   // for DBL_MAX
+#include <cmath>    // for floor
+#include <deque>
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+using namespace std;
+
+// Kahn's algorithm: fills the order and ranks if the graph is acyclic
+static bool topological_order(AdjacencyList<> *graph, vector<ulong> &order, vector<ulong> &rank)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    vector<ulong> indegree(num_vertices+1);
+
+    order.clear();
+    for (ulong v = 1; v<=num_vertices; ++v)
+    {
+        indegree[v] = graph->get_vertex(v)->get_indegree();
+        if (indegree[v] == 0)
+            order.push_back(v);
+    }
+
+    // the order itself serves as the queue
+    for (ulong k = 0; k<order.size(); ++k)
+    {
+        Edge* it = graph->get_vertex(order[k])->get_adjacencies();
+        while (it)
+        {
+            ulong x = it->get_successor()->get_key();
+            if (--indegree[x] == 0)
+                order.push_back(x);
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    if (order.size() < num_vertices)
+    {
+        order.clear();
+        return false;
+    }
+
+    rank.resize(num_vertices+1);
+    for (ulong k = 0; k<num_vertices; ++k)
+        rank[order[k]] = k;
+
+    return true;
+}
+
+/* whether each arc u->v has a reverse v->u of the same weight, in
+ * O(m log m): the arcs out of each vertex are sorted by head and weight, so
+ * that each reverse arc is found by binary search
+ */
+static bool symmetric_arcs(AdjacencyList<> *graph)
+{
+    long num_vertices = graph->get_vertex_count();
+
+    vector<ulong> first(num_vertices+2, 0);   // arcs of u at [first[u], first[u+1])
+    for (long u = 1; u <= num_vertices; ++u)
+        first[u+1] = first[u] + graph->get_vertex(u)->get_outdegree();
+    vector<pair<ulong, double> > arcs(first[num_vertices+1]);
+
+    bool symmetric = true;
+
+    #pragma omp parallel default(none) shared(graph, num_vertices, first, arcs) reduction(&&:symmetric)
+    {
+        #pragma omp for schedule(dynamic, 256)
+        for (long u = 1; u <= num_vertices; ++u)
+        {
+            ulong k = first[u];
+            for (Edge* it = graph->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+                arcs[k++] = make_pair(it->get_successor()->get_key(), it->get_weight());
+            sort(arcs.begin() + first[u], arcs.begin() + first[u+1]);
+        }
+
+        #pragma omp for schedule(dynamic, 256)
+        for (long u = 1; u <= num_vertices; ++u)
+        {
+            for (ulong k = first[u]; k<first[u+1] && symmetric; ++k)
+            {
+                ulong v = arcs[k].first;
+                symmetric = binary_search(arcs.begin() + first[v], arcs.begin() + first[v+1],
+                    make_pair((ulong) u, arcs[k].second));
+            }
+        }
+    }
+
+    return symmetric;
+}
+
+/*
+ * Graph analysis implementation
+ */
+
+const graph_properties& analyze_graph(AdjacencyList<> *graph)
+{
+    const graph_properties *known = graph->get_properties();
+    if (known)
+        return *known;
+
+    // a single analysis even if several threads ask at once
+    #pragma omp critical(analyze_graph)
+    if (!graph->get_properties())
+    {
+        long num_vertices = graph->get_vertex_count();
+
+        // openmp setup
+        if ( !magical_config::load_settings("analysis", num_vertices) )
+        {
+            std::cout << "Could not load settings from magical_config."
+                << "Using default values." << endl;
+
+            omp_set_num_threads(omp_get_num_procs());
+        }
+
+        double min_weight = DBL_MAX, max_weight = -DBL_MAX;
+        bool integer = true;
+        ulong arc_count = 0;
+
+        #pragma omp parallel for default(none) shared(graph, num_vertices) schedule(dynamic, 256) \
+            reduction(min:min_weight) reduction(max:max_weight) reduction(&&:integer) reduction(+:arc_count)
+        for (long u = 1; u <= num_vertices; ++u)
+        {
+            Edge* it = graph->get_vertex(u)->get_adjacencies();
+            for (; it; it = it->get_next())
+            {
+                double w = it->get_weight();
+                min_weight = min(min_weight, w);
+                max_weight = max(max_weight, w);
+                integer = integer && w == floor(w);
+                ++arc_count;
+            }
+        }
+
+        graph_properties p;
+        p.arc_count = arc_count;
+        p.min_weight = arc_count ? min_weight : 0;
+        p.max_weight = arc_count ? max_weight : 0;
+        p.nonnegative = p.min_weight >= 0;
+        p.integer = integer;
+        p.uniform = arc_count > 0 && p.min_weight == p.max_weight;
+        p.zero_one = integer && p.min_weight >= 0 && p.max_weight <= 1;
+        p.symmetric = symmetric_arcs(graph);
+        p.acyclic = topological_order(graph, p.topological_order, p.topological_rank);
+
+        graph->set_properties(p);
+    }
+
+    return *graph->get_properties();
+}
+
+/*
+ * Specialized single-source kernels: vertices are settled into the workspace
+ * without its queue
+ */
+
+// relaxation in topological order, from the rank of the source on
+static void dag_paths(AdjacencyList<> *graph, const graph_properties &p, ulong source, sssp_workspace *ws)
+{
+    ws->update(source, 0, 0);
+
+    for (ulong k = p.topological_rank[source]; k<p.topological_order.size(); ++k)
+    {
+        ulong u = p.topological_order[k];
+        double du = ws->get_distance(u);
+        if (du == DBL_MAX)
+            continue;
+
+        ws->settle(u);
+
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ws->update(it->get_successor()->get_key(), du + it->get_weight(), u);
+            it = it->get_next();   // next edge
+        }
+    }
+}
+
+/* 0-1 BFS: zero arcs push to the front of the deque and unit arcs to the
+ * back, so it holds at most two distances, in order
+ */
+static void zero_one_paths(AdjacencyList<> *graph, ulong source, sssp_workspace *ws)
+{
+    deque<ulong> queue(1, source);
+    ws->update(source, 0, 0);
+
+    while (!queue.empty())
+    {
+        ulong u = queue.front();
+        queue.pop_front();
+
+        if (ws->is_settled(u))
+            continue;   // stale entry
+        ws->settle(u);
+
+        double du = ws->get_distance(u);
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ulong v = it->get_successor()->get_key();
+            double w = it->get_weight();
+
+            if (ws->update(v, du + w, u))
+            {
+                if (w == 0)
+                    queue.push_front(v);
+                else
+                    queue.push_back(v);
+            }
+
+            it = it->get_next();   // next edge
+        }
+    }
+}
+
+// dijkstra on a radix heap, with stale entries skipped
+static void radix_heap_paths(AdjacencyList<> *graph, ulong source, sssp_workspace *ws)
+{
+    radix_heap queue;
+    queue.push(source, 0);
+    ws->update(source, 0, 0);
+
+    while (!queue.empty())
+    {
+        pair<ulong, ulong> e = queue.extract_min();
+        ulong u = e.second;
+
+        if (ws->is_settled(u) || e.first > ws->get_distance(u))
+            continue;   // stale entry
+        ws->settle(u);
+
+        double du = ws->get_distance(u);
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ulong v = it->get_successor()->get_key();
+            double d = du + it->get_weight();
+
+            if (ws->update(v, d, u))
+                queue.push(v, (ulong) d);
+
+            it = it->get_next();   // next edge
+        }
+    }
+}
+
+// bellman-ford, settling the vertices reached by distance
+static bool bellman_ford_paths(AdjacencyList<> *graph, ulong source, sssp_workspace *ws)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    vector<double> dist(num_vertices+1);
+    vector<ulong> pred(num_vertices+1);
+
+    if (!bellman_ford(graph, source, &dist[0], &pred[0]))
+        return false;
+
+    vector<pair<double, ulong> > reached;
+    for (ulong v = 1; v<=num_vertices; ++v)
+        if (dist[v] < DBL_MAX)
+            reached.push_back(make_pair(dist[v], v));
+    sort(reached.begin(), reached.end());
+
+    for (ulong k = 0; k<reached.size(); ++k)
+        ws->settle(reached[k].second, reached[k].first, pred[reached[k].second]);
+
+    return true;
+}
+
+int shortest_paths(AdjacencyList<> *graph, ulong source, sssp_workspace *ws)
+{
+    graph->get_vertex(source);   // throws NoSuchVertexException
+
+    const graph_properties &p = analyze_graph(graph);
+    ws->reset();
+
+    if (p.acyclic)
+    {
+        dag_paths(graph, p, source, ws);
+        return SSSP_DAG;
+    }
+
+    if (!p.nonnegative)
+        return bellman_ford_paths(graph, source, ws) ? SSSP_BELLMAN_FORD : SSSP_NEGATIVE_CYCLE;
+
+    if (p.uniform)
+    {
+        dijkstra(graph, source, ws);   // breadth-first, see paths.h
+        return SSSP_BFS;
+    }
+
+    if (p.zero_one)
+    {
+        zero_one_paths(graph, source, ws);
+        return SSSP_ZERO_ONE_BFS;
+    }
+
+    // integer keys, while distances stay exact as doubles (below 2^52)
+    if (p.integer && p.max_weight * graph->get_vertex_count() < 4503599627370496.0)
+    {
+        radix_heap_paths(graph, source, ws);
+        return SSSP_RADIX_HEAP;
+    }
+
+    dijkstra(graph, source, ws);
+    return SSSP_DIJKSTRA;
+}
@@ -0,0 +1,31 @@
+#ifndef __ANALYSIS_H__
+#define __ANALYSIS_H__
+
+#include "types.h"
+#include "sssp_workspace.h"
+
+// kernels chosen by shortest_paths()
+#define SSSP_DIJKSTRA       0   // binary heap
+#define SSSP_BFS            1   // every arc weighs the same
+#define SSSP_ZERO_ONE_BFS   2   // weights in {0, 1}: a deque instead of a heap
+#define SSSP_RADIX_HEAP     3   // nonnegative integer weights
+#define SSSP_DAG            4   // acyclic graphs: relaxation in topological order
+#define SSSP_BELLMAN_FORD   5   // negative weights
+#define SSSP_NEGATIVE_CYCLE 6   // negative cycle reachable from the source: no result
+
+/* properties of the graph (see graph_properties in types.h): weights are
+ * summarized in one parallel pass over the arcs, symmetry is checked on the
+ * arcs sorted by their ends (O(m log m)), then Kahn's algorithm tells whether
+ * the graph is acyclic. The result is
+ * cached on the graph until it changes (see AdjacencyList::get_properties())
+ */
+const graph_properties& analyze_graph(AdjacencyList<>*);
+
+/* single-source shortest paths by the cheapest kernel the properties of the
+ * graph allow, leaving the results in the workspace (which the dag kernel
+ * settles in topological order, and bellman-ford by distance). Returns the
+ * kernel used
+ */
+int shortest_paths(AdjacencyList<>*, unsigned long, sssp_workspace*);
+
+#endif /* __ANALYSIS_H__ */
@@ -0,0 +1,173 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "analysis.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// random DAG: arcs go from lower to higher keys, some of them negative
+AdjacencyList<>* randomDag(unsigned long num_vertices, unsigned long degree)
+{
+    AdjacencyList<> *g = new AdjacencyList<>(num_vertices);
+
+    for (unsigned long i=1; i<num_vertices; ++i)
+        for (unsigned long k=0; k<degree; ++k)
+            g->addEdge(i, i + 1 + rand() % (num_vertices - i), (double) (rand() % 100) - 20);
+
+    return g;
+}
+
+// dispatched search against bellman-ford from a few sources; returns the kernel
+int check_kernel(AdjacencyList<> *g, int *errors)
+{
+    unsigned long n = g->get_vertex_count();
+    sssp_workspace ws(n);
+    vector<double> dist(n+1);
+    vector<unsigned long> pred(n+1);
+    int kernel = -1;
+
+    for (unsigned long source = 1; source <= 3; ++source)
+    {
+        kernel = shortest_paths(g, source, &ws);
+        bellman_ford(g, source, &dist[0], &pred[0]);
+
+        unsigned long reached = 0;
+        for (unsigned long v = 1; v<=n; ++v)
+        {
+            *errors += check(ws.get_distance(v) == dist[v], "dispatched distance");
+            *errors += check(ws.is_settled(v) == (dist[v] < DBL_MAX), "dispatched settled");
+            reached += (dist[v] < DBL_MAX);
+
+            // predecessors: a tight arc
+            unsigned long p = ws.get_predecessor(v);
+            if (p != 0)
+            {
+                bool tight = false;
+                for (Edge* e = g->get_vertex(p)->get_adjacencies(); e; e = e->get_next())
+                    tight = tight || (e->get_successor()->get_key() == v && dist[p] + e->get_weight() == dist[v]);
+                *errors += check(tight, "dispatched predecessor");
+            }
+        }
+        *errors += check(ws.get_settled().size() == reached, "dispatched settled list");
+    }
+
+    return kernel;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 5000;
+
+    AdjacencyList<> *integer = randomGraph(n, 5, 100);
+    AdjacencyList<> *zero_one = randomGraph(n, 5, 1);
+    AdjacencyList<> *unit = randomGraph(n, 5, 0);
+    for (unsigned long u = 1; u<=n; ++u)
+        for (Edge* it = unit->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            it->set_weight(2);
+
+    AdjacencyList<> *real = randomGraph(n, 5, 100);
+    real->addEdge(1, 2, 0.5);
+    AdjacencyList<> *dag = randomDag(n, 5);
+
+    // negative arcs without negative cycles: reduced costs of random potentials
+    AdjacencyList<> *negative = randomGraph(n, 5, 100);
+    for (unsigned long u = 1; u<=n; ++u)
+        for (Edge* it = negative->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            it->set_weight(it->get_weight() + (double) (u % 7) - (double) (it->get_successor()->get_key() % 7));
+
+    // properties
+    const graph_properties &p = analyze_graph(integer);
+    errors += check(p.nonnegative && p.integer && !p.uniform && !p.zero_one && !p.acyclic && !p.symmetric
+        && p.arc_count == 5*n && p.min_weight >= 0 && p.max_weight <= 100, "integer graph properties");
+    errors += check(analyze_graph(zero_one).zero_one && analyze_graph(unit).uniform, "0-1 and uniform properties");
+    errors += check(!analyze_graph(real).integer && analyze_graph(dag).acyclic
+        && !analyze_graph(dag).nonnegative && analyze_graph(dag).topological_order.size() == n, "real and dag properties");
+
+    // cached until the graph changes
+    errors += check(integer->get_properties() == &analyze_graph(integer), "cached properties");
+    integer->addEdge(1, 2, 3);
+    errors += check(integer->get_properties() == 0, "properties forgotten");
+
+    // and when weights change in place
+    AdjacencyList<> *reweighted = new AdjacencyList<>(4);
+    reweighted->addEdge(1, 2, 1); reweighted->addEdge(1, 3, 5); reweighted->addEdge(3, 2, 10);
+    reweighted->addEdge(2, 4, 1); reweighted->addEdge(2, 1, 100);
+    sssp_workspace small_ws(4);
+    errors += check(shortest_paths(reweighted, 1, &small_ws) == SSSP_RADIX_HEAP && small_ws.get_distance(4) == 2,
+        "before set_weight");
+    reweighted->isEdge(3, 2)->set_weight(-10);
+    errors += check(reweighted->get_properties() == 0, "properties forgotten on set_weight");
+    errors += check(shortest_paths(reweighted, 1, &small_ws) == SSSP_BELLMAN_FORD && small_ws.get_distance(4) == -4,
+        "after set_weight");
+    delete reweighted;
+
+    AdjacencyList<> *symmetric = new AdjacencyList<>(4);
+    symmetric->addEdge(1, 2, 5); symmetric->addEdge(2, 1, 5);
+    symmetric->addEdge(2, 3, 1); symmetric->addEdge(3, 2, 1);
+    errors += check(analyze_graph(symmetric).symmetric, "symmetric graph");
+    symmetric->addEdge(3, 3, 7); symmetric->addEdge(1, 2, 4); symmetric->addEdge(2, 1, 4);
+    errors += check(analyze_graph(symmetric).symmetric, "symmetric graph with loops and parallel arcs");
+    symmetric->addEdge(2, 3, 2); symmetric->addEdge(3, 2, 3);
+    errors += check(!analyze_graph(symmetric).symmetric, "reverse arcs of other weights");
+    symmetric->addEdge(3, 2, 2); symmetric->addEdge(2, 3, 3); symmetric->addEdge(3, 4, 1);
+    errors += check(!analyze_graph(symmetric).symmetric, "asymmetric graph");
+
+    // kernels against bellman-ford
+    errors += check(check_kernel(integer, &errors) == SSSP_RADIX_HEAP, "radix heap kernel");
+    errors += check(check_kernel(zero_one, &errors) == SSSP_ZERO_ONE_BFS, "0-1 bfs kernel");
+    errors += check(check_kernel(unit, &errors) == SSSP_BFS, "bfs kernel");
+    errors += check(check_kernel(real, &errors) == SSSP_DIJKSTRA, "dijkstra kernel");
+    errors += check(check_kernel(dag, &errors) == SSSP_DAG, "dag kernel");
+    errors += check(check_kernel(negative, &errors) == SSSP_BELLMAN_FORD, "bellman-ford kernel");
+
+    sssp_workspace ws(n);
+    negative->addEdge(2, 1, -1000);
+    negative->addEdge(1, 2, 0);
+    errors += check(shortest_paths(negative, 1, &ws) == SSSP_NEGATIVE_CYCLE, "negative cycle");
+
+    // johnson on the dag (negative arcs, no potentials) against bellman-ford
+    unsigned long m = 400;
+    AdjacencyList<> *small_dag = randomDag(m, 4);
+    AllPairsResult<> result(m);
+    errors += check(johnson(small_dag, &result), "johnson on a dag");
+
+    vector<double> dist(m+1);
+    vector<unsigned long> pred(m+1);
+    for (unsigned long u = 1; u<=m; ++u)
+    {
+        bellman_ford(small_dag, u, &dist[0], &pred[0]);
+        for (unsigned long v = 1; v<=m; ++v)
+            errors += check(result.distance(u, v) == (dist[v] == DBL_MAX ? AllPairsResult<>::infinity() : dist[v]),
+                "johnson dag distance");
+    }
+
+    // timings: every source of the integer graph, dispatched and by dijkstra
+    integer->forget_properties();
+    double start = omp_get_wtime();
+    for (unsigned long u = 1; u<=n; u += 10)
+        shortest_paths(integer, u, &ws);
+    double dispatched_time = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    for (unsigned long u = 1; u<=n; u += 10)
+        dijkstra_within_radius(integer, u, DBL_MAX, &ws);
+    double heap_time = omp_get_wtime() - start;
+
+    cout << "integer weights: radix heap " << dispatched_time << "s, binary heap " << heap_time << "s" << endl;
+
+    delete integer; delete zero_one; delete unit; delete real; delete dag;
+    delete negative; delete symmetric; delete small_dag;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
@@ -0,0 +1,153 @@
+#include "astar.h"
+#include "heap.h"
+#include <cmath>    // for sqrt
+#include <cfloat>   // for DBL_MAX
+#include <algorithm>
+#include <omp.h>
+
+#define ulong unsigned long
+
+/*
+ * Euclidean heuristic implementation
+ */
+
+euclidean_heuristic::euclidean_heuristic(AdjacencyList<> *g, double s)
+{
+    graph = g;
+    scale = s;
+    target_x = target_y = 0;
+}
+
+euclidean_heuristic::euclidean_heuristic(AdjacencyList<> *g)
+{
+    graph = g;
+    target_x = target_y = 0;
+
+    /* tightest admissible scale: minimum ratio between arc weight and the
+     * straight-line distance joining its endpoints
+     */
+    long num_vertices = g->get_vertex_count();
+    double min_ratio = DBL_MAX;
+
+    #pragma omp parallel default(none) shared(g, num_vertices, min_ratio)
+    {
+        double local_min = DBL_MAX;
+
+        #pragma omp for schedule(static)
+        for (long u = 1; u <= num_vertices; ++u)
+        {
+            double ux = g->get_x(u);
+            double uy = g->get_y(u);
+
+            Edge* it = g->get_vertex(u)->get_adjacencies();
+            while (it)
+            {
+                ulong v = it->get_successor()->get_key();
+                double d = sqrt(pow(ux - g->get_x(v), 2) + pow(uy - g->get_y(v), 2));
+
+                if (d > 0)
+                    local_min = std::min(local_min, it->get_weight() / d);
+
+                it = it->get_next();
+            }
+        }
+
+        #pragma omp critical
+        min_ratio = std::min(min_ratio, local_min);
+    }
+
+    // no arc joins distinct points (any scale works), or negative weights
+    if (min_ratio == DBL_MAX)
+        min_ratio = 1;
+    else if (min_ratio < 0)
+        min_ratio = 0;
+
+    scale = min_ratio;
+}
+
+void euclidean_heuristic::set_target(ulong t)
+{
+    target_x = graph->get_x(t);
+    target_y = graph->get_y(t);
+}
+
+double euclidean_heuristic::estimate(ulong v) const
+{
+    double xd = graph->get_x(v) - target_x;
+    double yd = graph->get_y(v) - target_y;
+    return scale * sqrt(xd*xd + yd*yd);
+}
+
+double euclidean_heuristic::get_scale() const { return scale; }
+
+/*
+ * A* implementation
+ */
+double astar(AdjacencyList<> *graph, ulong source, ulong target, std::vector<ulong> *path, astar_heuristic *h)
+{
+    ulong num_vertices = graph->get_vertex_count();
+
+    // validate both endpoints (throws NoSuchVertexException)
+    graph->get_vertex(source);
+    graph->get_vertex(target);
+
+    h->set_target(target);
+
+    // g in A*: current shortest path estimate from source
+    std::vector<double> estimate(num_vertices+1, DBL_MAX);
+    std::vector<ulong> predecessor(num_vertices+1, 0);
+    std::vector<bool> settled(num_vertices+1, false);
+    vertex_heap open(num_vertices);
+
+    estimate[source] = 0;
+    open.push(source, h->estimate(source));
+
+    /* algorithm kernel: select the vertex with smallest estimate + lower bound
+     * to the target, and relax its arcs; stop as soon as the target is settled
+     */
+    while (!open.empty())
+    {
+        ulong u = open.extract_min();
+        if (u == target)
+            break;
+
+        settled[u] = true;
+
+        Edge* adj = graph->get_vertex(u)->get_adjacencies();
+        while (adj)
+        {
+            ulong v = adj->get_successor()->get_key();
+            double d = estimate[u] + adj->get_weight();
+
+            // relax arc(u,v); consistent bounds never reopen settled vertices
+            if (!settled[v] && d < estimate[v])
+            {
+                // prune vertices the heuristic proves cannot reach the target
+                double hv = h->estimate(v);
+                if (hv < DBL_MAX)
+                {
+                    estimate[v] = d;
+                    predecessor[v] = u;
+                    open.push(v, d + hv);
+                }
+            }
+
+            adj = adj->get_next();   // next edge
+        }
+    }
+
+    // path: walk back the predecessors from target
+    if (path)
+    {
+        path->clear();
+        if (estimate[target] < DBL_MAX)
+        {
+            for (ulong v = target; v != source; v = predecessor[v])
+                path->push_back(v);
+            path->push_back(source);
+            std::reverse(path->begin(), path->end());
+        }
+    }
+
+    return estimate[target];
+}
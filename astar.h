@@ -0,0 +1,54 @@
+#ifndef __ASTAR_H__
+#define __ASTAR_H__
+
+#include <vector>
+#include "types.h"
+
+/**
+ * astar_heuristic: lower bound on the distance from each vertex to the current
+ * target. Implementations must be consistent, i.e. h(u) <= w(u,v) + h(v) for
+ * every arc (u,v), so that A* never needs to reopen a settled vertex.
+ */
+class astar_heuristic
+{
+public:
+    virtual ~astar_heuristic() { }
+
+    // called once per query, before any estimate is requested
+    virtual void set_target(unsigned long) = 0;
+
+    virtual double estimate(unsigned long) const = 0;
+};
+
+
+/**
+ * euclidean_heuristic: straight-line distance to the target, for graphs which
+ * keep vertex coordinates. Distances are multiplied by 'scale', the largest
+ * factor such that w(u,v) >= scale * |uv| holds for every arc; it is computed
+ * from the graph when not given (e.g. TSPLIB rounds weights to the nearest
+ * integer, so some arcs are slightly shorter than the straight line).
+ */
+class euclidean_heuristic : public astar_heuristic
+{
+public:
+    euclidean_heuristic(AdjacencyList<>*);
+    euclidean_heuristic(AdjacencyList<>*, double);
+
+    void set_target(unsigned long);
+    double estimate(unsigned long) const;
+
+    double get_scale() const;
+
+private:
+    AdjacencyList<>* graph;
+    double scale;
+    double target_x, target_y;
+};
+
+
+/* A* point-to-point shortest path: returns the distance from source to target
+ * (DBL_MAX if unreachable) and stores the path, if requested (may be 0)
+ */
+double astar(AdjacencyList<>*, unsigned long, unsigned long, std::vector<unsigned long>*, astar_heuristic*);
+
+#endif /* __ASTAR_H__ */
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include "types.h"
+#include "paths.h"
+#include "astar.h"
+#include "tsplib.h"
+
+#include <sys/time.h>       // for 'gettimeofday()'
+
+#define NUM_QUERIES 20
+
+using namespace std;
+
+// -- time evaluation functions ------------------------------------------------
+
+double wall_time()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1.e-6 * t.tv_usec;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        cout << "usage: " << argv[0] << " [tsplib_file]" << endl;
+        return 1;
+    }
+
+    AdjacencyList<> *graph = graph_from_tsplib(argv[1]);
+
+    if (graph == 0)
+        return(0);
+
+    unsigned long num_vertices = graph->get_vertex_count();
+    double *distances = new double[num_vertices+1];
+    vector<unsigned long> *paths = new vector<unsigned long>[num_vertices+1];
+
+    euclidean_heuristic h(graph);
+    cout << "heuristic scale: " << h.get_scale() << endl;
+
+    srand(1234567);
+    double dijkstra_time = 0, astar_time = 0;
+    int mismatches = 0;
+
+    // s->t queries: A* against the distance computed by a full dijkstra
+    for (int q = 0; q < NUM_QUERIES; ++q)
+    {
+        unsigned long s = (rand() % num_vertices) + 1;
+        unsigned long t = (rand() % num_vertices) + 1;
+
+        double start = wall_time();
+        dijkstra(graph, s, distances, paths);
+        dijkstra_time += wall_time() - start;
+
+        vector<unsigned long> path;
+        start = wall_time();
+        double d = astar(graph, s, t, &path, &h);
+        astar_time += wall_time() - start;
+
+        if (d != distances[t] || path.front() != s || path.back() != t)
+        {
+            cout << "mismatch " << s << " -> " << t << ": astar " << d
+                << " dijkstra " << distances[t] << endl;
+            ++mismatches;
+        }
+    }
+
+    printf("dijkstra: %.6f\nastar:    %.6f\n", dijkstra_time, astar_time);
+    cout << mismatches << " mismatches in " << NUM_QUERIES << " queries" << endl;
+
+    delete[] distances;
+    delete[] paths;
+    delete graph;
+
+    return mismatches;
+}
@@ -0,0 +1,262 @@
+#include "batched_paths.h"
+#include <omp.h>
+#include <cfloat>    // for DBL_MAX
+#include <climits>   // for CHAR_BIT
+#include <cstdlib>   // for atol
+#include <cmath>     // for floor
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+#define LANES (sizeof(ulong) * CHAR_BIT)   // sources per batch
+
+using namespace std;
+
+// per-thread state of a batch, indexed by vertex (masks hold one bit per lane)
+typedef struct {
+    vector<vector<ulong> > bucket;     // arrival masks, by distance modulo W+1
+    vector<vector<ulong> > arrived;    // vertices with a nonzero mask, per bucket
+    vector<ulong> seen;                // lanes which settled the vertex
+    vector<ulong> fresh;               // lanes settled at the current distance
+    vector<ulong> spread;              // of those, lanes not yet sent along zero arcs
+    vector<ulong> frontier, zero_queue;
+    vector<double> rows;               // distances of every lane, row after row
+} batch_workspace;
+
+static ulong max_batched_weight()
+{
+    string setting = magical_config::get_setting("batched", "max_weight");
+    return setting.empty() ? 16 : atol(setting.c_str());
+}
+
+/* checks that every weight is an integer in [0, limit], giving the largest one
+ * and whether some arc weighs zero
+ */
+static bool integer_weights(AdjacencyList<> *graph, ulong limit, ulong *max_weight, bool *zero_arcs)
+{
+    *max_weight = 0;
+    *zero_arcs = false;
+
+    for (ulong u = 1; u<=graph->get_vertex_count(); ++u)
+    {
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            double w = it->get_weight();
+            if (w < 0 || w > limit || w != floor(w))
+                return false;
+
+            *max_weight = max(*max_weight, (ulong) w);
+            *zero_arcs = *zero_arcs || w == 0;
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    return true;
+}
+
+// distance 'level' for every lane of 'mask' at vertex v
+static void record(batch_workspace &bw, ulong stride, ulong v, ulong mask, ulong level)
+{
+    while (mask)
+    {
+        bw.rows[__builtin_ctzl(mask) * stride + v] = level;
+        mask &= mask - 1;   // next lane
+    }
+}
+
+/* distances from sources[first, first+count): walks the distances in order,
+ * settling at each one the lanes arrived in its bucket, then spreading them
+ * along zero arcs (if any) and into the buckets ahead along the others
+ */
+static void run_batch(AdjacencyList<> *graph, const vector<ulong> &sources, ulong first, ulong count,
+    bool zero_arcs, batch_workspace &bw, apsp_row_sink *sink)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    ulong stride = num_vertices + 1;
+    ulong num_buckets = bw.bucket.size();
+
+    ulong pending = 0;   // entries of every bucket list
+    for (ulong i = 0; i<count; ++i)
+    {
+        ulong s = sources[first + i];
+        if (bw.bucket[0][s] == 0)
+        {
+            bw.arrived[0].push_back(s);
+            ++pending;
+        }
+        bw.bucket[0][s] |= 1UL << i;
+    }
+
+    for (ulong level = 0; pending > 0; ++level)
+    {
+        ulong b = level % num_buckets;
+        vector<ulong> &arrived = bw.arrived[b];
+        pending -= arrived.size();
+
+        // settle the lanes arriving at this distance for the first time
+        bw.frontier.clear();
+        for (ulong k = 0; k<arrived.size(); ++k)
+        {
+            ulong v = arrived[k];
+            ulong mask = bw.bucket[b][v] & ~bw.seen[v];
+            bw.bucket[b][v] = 0;
+
+            if (mask)
+            {
+                bw.seen[v] |= mask;
+                bw.fresh[v] = mask;
+                bw.frontier.push_back(v);
+                record(bw, stride, v, mask, level);
+
+                if (zero_arcs)
+                {
+                    bw.spread[v] = mask;
+                    bw.zero_queue.push_back(v);
+                }
+            }
+        }
+        arrived.clear();
+
+        // zero arcs: same distance, until no lane spreads further
+        for (ulong k = 0; k<bw.zero_queue.size(); ++k)
+        {
+            ulong v = bw.zero_queue[k];
+            ulong mask = bw.spread[v];
+            bw.spread[v] = 0;
+
+            Edge* it = graph->get_vertex(v)->get_adjacencies();
+            for (; it; it = it->get_next())
+            {
+                if (it->get_weight() != 0)
+                    continue;
+
+                ulong x = it->get_successor()->get_key();
+                ulong reached = mask & ~bw.seen[x];
+                if (!reached)
+                    continue;
+
+                bw.seen[x] |= reached;
+                record(bw, stride, x, reached, level);
+
+                if (!bw.fresh[x])
+                    bw.frontier.push_back(x);
+                bw.fresh[x] |= reached;
+
+                if (!bw.spread[x])
+                    bw.zero_queue.push_back(x);
+                bw.spread[x] |= reached;
+            }
+        }
+        bw.zero_queue.clear();
+
+        // other arcs: into the bucket of their head's distance
+        for (ulong k = 0; k<bw.frontier.size(); ++k)
+        {
+            ulong v = bw.frontier[k];
+            ulong mask = bw.fresh[v];
+            bw.fresh[v] = 0;
+
+            Edge* it = graph->get_vertex(v)->get_adjacencies();
+            for (; it; it = it->get_next())
+            {
+                ulong w = (ulong) it->get_weight();
+                ulong x = it->get_successor()->get_key();
+                ulong reached = mask & ~bw.seen[x];
+
+                if (w == 0 || !reached)
+                    continue;
+
+                ulong ahead = (level + w) % num_buckets;
+                if (bw.bucket[ahead][x] == 0)
+                {
+                    bw.arrived[ahead].push_back(x);
+                    ++pending;
+                }
+                bw.bucket[ahead][x] |= reached;
+            }
+        }
+    }
+
+    // hand over the rows, then reset them for the next batch
+    for (ulong i = 0; i<count; ++i)
+    {
+        double *row = &bw.rows[i * stride];
+        sink->store_row(sources[first + i], row, 0);
+        fill(row, row + stride, DBL_MAX);
+    }
+
+    fill(bw.seen.begin(), bw.seen.end(), 0);
+}
+
+/*
+ * Batched multi-source implementation
+ */
+
+bool batched_weights(AdjacencyList<> *graph)
+{
+    ulong max_weight;
+    bool zero_arcs;
+
+    return integer_weights(graph, max_batched_weight(), &max_weight, &zero_arcs);
+}
+
+bool batched_distances(AdjacencyList<> *graph, const vector<ulong> &sources, apsp_row_sink *sink)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    for (ulong i = 0; i<sources.size(); ++i)
+        graph->get_vertex(sources[i]);   // throws NoSuchVertexException
+
+    ulong max_weight;
+    bool zero_arcs;
+    if (!integer_weights(graph, max_batched_weight(), &max_weight, &zero_arcs))
+    {
+        cerr << "[magical] graph given to batched distances has weights other than small integers." << endl;
+        return false;
+    }
+
+    // openmp setup
+    if ( !magical_config::load_settings("batched", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    long num_batches = (sources.size() + LANES - 1) / LANES;
+    if (num_batches == 0)
+        return true;
+
+    // no more threads than batches, as each holds rows for a whole batch
+    int num_threads = (int) min((long) omp_get_max_threads(), num_batches);
+
+    #pragma omp parallel num_threads(num_threads) default(none) shared(graph, sources, sink, num_vertices, max_weight, zero_arcs, num_batches)
+    {
+        batch_workspace bw;
+
+        #pragma omp for schedule(dynamic)
+        for (long b = 0; b < num_batches; ++b)
+        {
+            if (bw.seen.empty())   // on the first batch of the thread
+            {
+                bw.bucket.assign(max_weight + 1, vector<ulong>(num_vertices+1, 0));
+                bw.arrived.resize(max_weight + 1);
+                bw.seen.assign(num_vertices+1, 0);
+                bw.fresh.assign(num_vertices+1, 0);
+                bw.spread.assign(num_vertices+1, 0);
+                bw.rows.assign(LANES * (num_vertices+1), DBL_MAX);
+            }
+
+            ulong first = b * LANES;
+            ulong count = min((ulong) LANES, sources.size() - first);
+
+            run_batch(graph, sources, first, count, zero_arcs, bw, sink);
+        }
+    }
+
+    return true;
+}
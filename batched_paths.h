@@ -0,0 +1,35 @@
+#ifndef __BATCHED_PATHS_H__
+#define __BATCHED_PATHS_H__
+
+#include <vector>
+#include "types.h"
+#include "paths.h"
+
+/**
+ * Multi-source shortest distances for graphs whose weights are small
+ * nonnegative integers (unit weights included), after the multi-source BFS of
+ * Then et al. (2014). One bit per source in a machine word: a batch of up to
+ * 64 sources walks the graph together, each vertex keeping the mask of
+ * sources that reached it, so an arc is scanned once for every source
+ * arriving through it at the same distance instead of once per source.
+ *
+ * Weights up to W are handled by W+1 rotating arrival masks (a bit-parallel
+ * bucket queue): bits crossing an arc of weight w land in the bucket of
+ * distance d+w, and zero-weight arcs spread within the current distance.
+ * Batches run in parallel, each thread holding (W+3) masks and 64 distance
+ * rows per vertex.
+ */
+
+/* whether the batched engine handles the graph: every weight an integer in
+ * [0, max_weight] of multi_source_batches in magical_config (16 by default)
+ */
+bool batched_weights(AdjacencyList<>*);
+
+/* distances from each source, given to the sink as rows (DBL_MAX if
+ * unreachable) without predecessors: the last argument of store_row() is 0,
+ * so only distance sinks fit (statistics, distance files). Returns false if
+ * the weights do not suit the engine
+ */
+bool batched_distances(AdjacencyList<>*, const std::vector<unsigned long>&, apsp_row_sink*);
+
+#endif /* __BATCHED_PATHS_H__ */
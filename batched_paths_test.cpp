@@ -0,0 +1,141 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "batched_paths.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// row sink comparing each row against dijkstra from its source
+class dijkstra_checker : public apsp_row_sink
+{
+public:
+    dijkstra_checker(AdjacencyList<> *g) { graph = g; rows = mismatches = 0; }
+
+    void store_row(unsigned long u, const double *d, const unsigned long*)
+    {
+        sssp_workspace ws(graph->get_vertex_count());
+        dijkstra(graph, u, &ws);
+
+        unsigned long wrong = 0;
+        for (unsigned long v = 1; v <= graph->get_vertex_count(); ++v)
+            if (d[v] != ws.get_distance(v))
+                ++wrong;
+
+        #pragma omp critical
+        {
+            ++rows;
+            mismatches += wrong;
+        }
+    }
+
+    unsigned long rows, mismatches;
+
+private:
+    AdjacencyList<> *graph;
+};
+
+// row sink doing nothing, for timings
+class null_sink : public apsp_row_sink
+{
+public:
+    void store_row(unsigned long, const double*, const unsigned long*) { }
+};
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 3000;
+
+    // small integer weights (zero included), unit weights and a non-integer one
+    AdjacencyList<> *weighted = randomGraph(n, 4, 5);
+    AdjacencyList<> *unit = randomGraph(n, 4, 0);
+    for (unsigned long u = 1; u<=n; ++u)
+        for (Edge* it = unit->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            it->set_weight(1);
+    AdjacencyList<> *real = randomGraph(200, 4, 5);
+    real->addEdge(1, 2, 0.5);
+
+    errors += check(batched_weights(weighted) && batched_weights(unit), "batched weights");
+    errors += check(!batched_weights(real), "non-integer weights rejected");
+
+    // a partial batch and repeated sources
+    vector<unsigned long> sources;
+    for (unsigned long i = 0; i<150; ++i)
+        sources.push_back((i*37) % n + 1);
+    sources.push_back(sources[0]);
+
+    AdjacencyList<> *graphs[] = { weighted, unit };
+    for (int g = 0; g<2; ++g)
+    {
+        dijkstra_checker checker(graphs[g]);
+        errors += check(batched_distances(graphs[g], sources, &checker), "batched distances");
+        errors += check(checker.rows == sources.size() && checker.mismatches == 0, "batched rows");
+
+        // many-to-many goes to the batched engine
+        vector<unsigned long> targets;
+        for (unsigned long j = 0; j<40; ++j)
+            targets.push_back((j*101) % n + 1);
+
+        vector<double> table(sources.size() * targets.size());
+        many_to_many(graphs[g], sources, targets, &table[0]);
+
+        sssp_workspace ws(n);
+        for (unsigned long i = 0; i<sources.size(); ++i)
+        {
+            dijkstra(graphs[g], sources[i], &ws);
+            for (unsigned long j = 0; j<targets.size(); ++j)
+                errors += check(table[i*targets.size() + j] == ws.get_distance(targets[j]), "many-to-many entry");
+        }
+    }
+
+    // all-pairs statistics agree with the johnson rows
+    apsp_statistics stats;
+    errors += check(all_pairs_statistics(unit, &stats), "all-pairs statistics");
+
+    unsigned long pairs = 0;
+    sssp_workspace ws(n);
+    double diameter = 0;
+    for (unsigned long u = 1; u<=n; ++u)
+    {
+        dijkstra(unit, u, &ws);
+        for (unsigned long v = 1; v<=n; ++v)
+            if (v != u && ws.get_distance(v) < DBL_MAX)
+            {
+                ++pairs;
+                diameter = max(diameter, ws.get_distance(v));
+            }
+    }
+    errors += check(stats.reachable_pairs == pairs && stats.diameter == diameter, "statistics from batches");
+
+    // every source: batched engine against johnson
+    vector<unsigned long> all(n);
+    for (unsigned long v = 1; v<=n; ++v)
+        all[v-1] = v;
+
+    null_sink nothing;
+    double start = omp_get_wtime();
+    batched_distances(unit, all, &nothing);
+    double batched_time = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    johnson(unit, &nothing);
+    double johnson_time = omp_get_wtime() - start;
+
+    cout << "all sources, unit weights: batched " << batched_time << "s, johnson " << johnson_time << "s" << endl;
+
+    delete weighted;
+    delete unit;
+    delete real;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
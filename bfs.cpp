@@ -0,0 +1,273 @@
+#include "bfs.h"
+#include <omp.h>
+#include <climits>   // for ULONG_MAX, CHAR_BIT
+#include <cstdlib>   // for atof
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+#define BITS (sizeof(ulong) * CHAR_BIT)   // vertices per bitmap word
+#define UNVISITED ULONG_MAX
+
+using namespace std;
+
+static double bfs_factor(const char *key, double fallback)
+{
+    string setting = magical_config::get_setting("bfs", key);
+    return setting.empty() ? fallback : atof(setting.c_str());
+}
+
+/*
+ * Direction-optimizing BFS implementation
+ */
+
+parallel_bfs::parallel_bfs(AdjacencyList<> *g)
+{
+    graph = g;
+    vertex_count = g->get_vertex_count();
+    arc_count = 0;
+    bottom_up_steps = 0;
+
+    // in-arcs in contiguous lists, counted first
+    out_degree.assign(vertex_count+1, 0);
+    in_first.assign(vertex_count+2, 0);
+    for (ulong u = 1; u<=vertex_count; ++u)
+    {
+        Edge* it = g->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ++out_degree[u];
+            ++in_first[it->get_successor()->get_key() + 1];
+            it = it->get_next();   // next edge
+        }
+        arc_count += out_degree[u];
+    }
+
+    for (ulong v = 1; v<=vertex_count; ++v)
+        in_first[v+1] += in_first[v];
+
+    in_tail.resize(arc_count);
+    vector<ulong> pos(in_first.begin(), in_first.end() - 1);
+    for (ulong u = 1; u<=vertex_count; ++u)
+    {
+        Edge* it = g->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            in_tail[pos[it->get_successor()->get_key()]++] = u;
+            it = it->get_next();   // next edge
+        }
+    }
+
+    frontier_bits.assign(vertex_count / BITS + 1, 0);
+    next_bits.assign(vertex_count / BITS + 1, 0);
+}
+
+parallel_bfs::~parallel_bfs() { }
+
+ulong parallel_bfs::run(ulong source, ulong *levels, ulong *parents) throw (NoSuchVertexException)
+{
+    graph->get_vertex(source);   // throws NoSuchVertexException
+
+    // openmp setup
+    if ( !magical_config::load_settings("bfs", vertex_count) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    double alpha = bfs_factor("alpha", 14);
+    double beta = bfs_factor("beta", 24);
+
+    long num_vertices = vertex_count;
+    #pragma omp parallel for default(none) shared(levels, parents, num_vertices)
+    for (long v = 1; v <= num_vertices; ++v)
+    {
+        levels[v] = UNVISITED;
+        parents[v] = 0;
+    }
+
+    levels[source] = 0;
+    frontier.assign(1, source);
+
+    ulong reached = 1, frontier_size = 1;
+    ulong frontier_arcs = out_degree[source];
+    ulong unexplored_arcs = arc_count - frontier_arcs;
+    bool bottom_up = false;
+    bottom_up_steps = 0;
+
+    for (ulong depth = 0; frontier_size > 0; ++depth)
+    {
+        ulong previous_size = frontier_size;
+
+        if (!bottom_up && frontier_arcs > unexplored_arcs / alpha)
+        {
+            to_bitmap();
+            bottom_up = true;
+        }
+
+        if (bottom_up)
+        {
+            bottom_up_step(depth, levels, parents, &frontier_size);
+            ++bottom_up_steps;
+        }
+        else
+            top_down_step(depth, levels, parents, &frontier_size);
+
+        // arcs leaving the new frontier
+        frontier_arcs = 0;
+        if (bottom_up)
+        {
+            for (ulong w = 0; w<frontier_bits.size(); ++w)
+                for (ulong bits = frontier_bits[w]; bits; bits &= bits - 1)
+                    frontier_arcs += out_degree[w * BITS + __builtin_ctzl(bits)];
+        }
+        else
+        {
+            for (ulong i = 0; i<frontier.size(); ++i)
+                frontier_arcs += out_degree[frontier[i]];
+        }
+
+        unexplored_arcs -= min(unexplored_arcs, frontier_arcs);
+        reached += frontier_size;
+
+        // back to top-down once the frontier is small and shrinking
+        if (bottom_up && frontier_size < previous_size && frontier_size < vertex_count / beta)
+        {
+            to_queue();
+            bottom_up = false;
+        }
+    }
+
+    return reached;
+}
+
+/* top-down: heads of the frontier's out-arcs are claimed by the first thread
+ * to swap their level
+ */
+void parallel_bfs::top_down_step(ulong depth, ulong *levels, ulong *parents, ulong *frontier_size)
+{
+    next_frontier.clear();
+    long size = frontier.size();
+
+    #pragma omp parallel default(none) shared(levels, parents, depth, size)
+    {
+        vector<ulong> found;
+
+        #pragma omp for schedule(dynamic, 64)
+        for (long i = 0; i < size; ++i)
+        {
+            ulong u = frontier[i];
+
+            Edge* it = graph->get_vertex(u)->get_adjacencies();
+            for (; it; it = it->get_next())
+            {
+                ulong v = it->get_successor()->get_key();
+                ulong level;
+
+                #pragma omp atomic read
+                level = levels[v];
+
+                if (level != UNVISITED)
+                    continue;
+
+                #pragma omp atomic capture
+                { level = levels[v]; levels[v] = depth + 1; }
+
+                if (level == UNVISITED)
+                {
+                    parents[v] = u;
+                    found.push_back(v);
+                }
+            }
+        }
+
+        #pragma omp critical(parallel_bfs)
+        next_frontier.insert(next_frontier.end(), found.begin(), found.end());
+    }
+
+    frontier.swap(next_frontier);
+    *frontier_size = frontier.size();
+}
+
+/* bottom-up: each unvisited vertex looks for a parent in the frontier; a
+ * thread owns whole bitmap words, so no bit is written concurrently
+ */
+void parallel_bfs::bottom_up_step(ulong depth, ulong *levels, ulong *parents, ulong *frontier_size)
+{
+    long num_words = frontier_bits.size();
+    ulong found = 0;
+
+    #pragma omp parallel for default(none) shared(levels, parents, depth, num_words) reduction(+:found) schedule(dynamic, 16)
+    for (long w = 0; w < num_words; ++w)
+    {
+        ulong bits = 0;
+        ulong first = max((ulong) 1, w * BITS);
+        ulong last = min(vertex_count, (w+1) * BITS - 1);
+
+        for (ulong v = first; v <= last; ++v)
+        {
+            if (levels[v] != UNVISITED)
+                continue;
+
+            for (ulong i = in_first[v]; i<in_first[v+1]; ++i)
+            {
+                ulong u = in_tail[i];
+                if (frontier_bits[u / BITS] & (1UL << (u % BITS)))
+                {
+                    levels[v] = depth + 1;
+                    parents[v] = u;
+                    bits |= 1UL << (v % BITS);
+                    ++found;
+                    break;
+                }
+            }
+        }
+
+        next_bits[w] = bits;
+    }
+
+    frontier_bits.swap(next_bits);
+    *frontier_size = found;
+}
+
+void parallel_bfs::to_bitmap()
+{
+    fill(frontier_bits.begin(), frontier_bits.end(), 0);
+    for (ulong i = 0; i<frontier.size(); ++i)
+        frontier_bits[frontier[i] / BITS] |= 1UL << (frontier[i] % BITS);
+}
+
+void parallel_bfs::to_queue()
+{
+    frontier.clear();
+    for (ulong w = 0; w<frontier_bits.size(); ++w)
+        for (ulong bits = frontier_bits[w]; bits; bits &= bits - 1)
+            frontier.push_back(w * BITS + __builtin_ctzl(bits));
+}
+
+ulong parallel_bfs::get_bottom_up_steps() const { return bottom_up_steps; }
+
+bool uniform_weight(AdjacencyList<> *graph, double *weight)
+{
+    bool any = false;
+    for (ulong u = 1; u<=graph->get_vertex_count(); ++u)
+    {
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            if (any && it->get_weight() != *weight)
+                return false;
+
+            *weight = it->get_weight();
+            any = true;
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    return any;
+}
@@ -0,0 +1,61 @@
+#ifndef __BFS_H__
+#define __BFS_H__
+
+#include <vector>
+#include "types.h"
+
+/**
+ * parallel_bfs: direction-optimizing breadth-first search (Beamer et al.
+ * 2012). Small frontiers expand top-down, each thread scanning the out-arcs of
+ * its share of the frontier and claiming unvisited heads atomically. Once the
+ * arcs leaving the frontier outnumber the unexplored ones by a factor alpha,
+ * steps run bottom-up: every unvisited vertex scans its in-arcs for a parent
+ * in the frontier bitmap, stopping at the first one, until the frontier shrinks
+ * below n/beta. Both factors come from direction_optimizing_bfs in
+ * magical_config (14 and 24 by default).
+ *
+ * The constructor gathers the in-arcs (O(n+m) memory), so an engine is meant
+ * to be reused for many searches on an unchanged graph.
+ */
+class parallel_bfs
+{
+public:
+    // constructor and destructor
+    parallel_bfs(AdjacencyList<>*);
+    virtual ~parallel_bfs();
+
+    /* hop counts from the source (ULONG_MAX if unreachable) and parents (0 for
+     * the source and unreachable vertices), indexed 1..n; returns the number of
+     * vertices reached, the source included
+     */
+    unsigned long run(unsigned long, unsigned long*, unsigned long*) throw (NoSuchVertexException);
+
+    // steps of the last search which ran bottom-up
+    unsigned long get_bottom_up_steps() const;
+
+private:
+    void top_down_step(unsigned long, unsigned long*, unsigned long*, unsigned long*);
+    void bottom_up_step(unsigned long, unsigned long*, unsigned long*, unsigned long*);
+    void to_bitmap();
+    void to_queue();
+
+    AdjacencyList<> *graph;
+    unsigned long vertex_count, arc_count;
+    std::vector<unsigned long> out_degree;
+
+    // in-arcs of v: tails in_tail[in_first[v] .. in_first[v+1])
+    std::vector<unsigned long> in_first, in_tail;
+
+    // frontier, as a queue (top-down) or a bitmap (bottom-up)
+    std::vector<unsigned long> frontier, next_frontier;
+    std::vector<unsigned long> frontier_bits, next_bits;
+
+    unsigned long bottom_up_steps;
+};
+
+/* weight shared by every arc of the graph; false if weights differ or there
+ * are no arcs
+ */
+bool uniform_weight(AdjacencyList<>*, double*);
+
+#endif /* __BFS_H__ */
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <cstdlib>
+#include <cfloat>
+#include <climits>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "bfs.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// random graph whose arcs all weigh 'weight'
+AdjacencyList<>* uniformGraph(unsigned long num_vertices, unsigned long degree, double weight)
+{
+    AdjacencyList<> *g = new AdjacencyList<>(num_vertices);
+
+    srand(1234567);
+
+    for (unsigned long i=1; i<=num_vertices; ++i)
+        for (unsigned long k=0; k<degree; ++k)
+            g->addEdge(i, (rand() % num_vertices) + 1, weight);
+
+    return g;
+}
+
+// plain sequential breadth-first search, as a reference
+void reference_levels(AdjacencyList<> *g, unsigned long source, vector<unsigned long> &levels)
+{
+    levels.assign(g->get_vertex_count()+1, ULONG_MAX);
+    levels[source] = 0;
+
+    queue<unsigned long> q;
+    q.push(source);
+    while (!q.empty())
+    {
+        unsigned long u = q.front();
+        q.pop();
+
+        for (Edge* it = g->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+        {
+            unsigned long v = it->get_successor()->get_key();
+            if (levels[v] == ULONG_MAX)
+            {
+                levels[v] = levels[u] + 1;
+                q.push(v);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 200000;
+    AdjacencyList<> *graph = uniformGraph(n, 8, 3);
+
+    double weight = 0;
+    errors += check(uniform_weight(graph, &weight) && weight == 3, "uniform weight");
+
+    parallel_bfs bfs(graph);
+    vector<unsigned long> levels(n+1), parents(n+1), expected;
+    sssp_workspace ws(n);
+
+    for (unsigned long source = 1; source <= 3; ++source)
+    {
+        double start = omp_get_wtime();
+        unsigned long reached = bfs.run(source, &levels[0], &parents[0]);
+        double bfs_time = omp_get_wtime() - start;
+
+        reference_levels(graph, source, expected);
+        unsigned long expected_reached = 0;
+        for (unsigned long v = 1; v<=n; ++v)
+        {
+            errors += check(levels[v] == expected[v], "bfs level");
+            expected_reached += (expected[v] != ULONG_MAX);
+
+            // parents: one level up, through an arc
+            if (v != source && levels[v] != ULONG_MAX)
+                errors += check(levels[parents[v]] + 1 == levels[v] && graph->isEdge(parents[v], v) != 0, "bfs parent");
+        }
+        errors += check(reached == expected_reached && parents[source] == 0, "bfs reached");
+        errors += check(bfs.get_bottom_up_steps() > 0, "bottom-up steps taken");
+
+        // dispatched dijkstra against the heap-based search
+        start = omp_get_wtime();
+        dijkstra(graph, source, &ws);
+        double dispatched_time = omp_get_wtime() - start;
+
+        sssp_workspace heap_ws(n);
+        start = omp_get_wtime();
+        dijkstra_within_radius(graph, source, DBL_MAX, &heap_ws);
+        double heap_time = omp_get_wtime() - start;
+
+        for (unsigned long v = 1; v<=n; ++v)
+            errors += check(ws.get_distance(v) == heap_ws.get_distance(v)
+                && ws.is_settled(v) == (expected[v] != ULONG_MAX), "breadth-first dijkstra");
+        errors += check(ws.get_settled().size() == expected_reached, "breadth-first settled");
+
+        cout << "source " << source << ": parallel bfs " << bfs_time << "s, breadth-first dijkstra "
+            << dispatched_time << "s, heap dijkstra " << heap_time << "s" << endl;
+    }
+
+    // legacy dijkstra: paths from the bfs parents
+    double *dist = new double[n+1];
+    vector<unsigned long> *paths = new vector<unsigned long>[n+1];
+    dijkstra(graph, 1, dist, paths);
+    reference_levels(graph, 1, expected);
+    for (unsigned long v = 1; v<=n; ++v)
+    {
+        bool reachable = expected[v] != ULONG_MAX;
+        errors += check(dist[v] == (reachable ? 3.0 * expected[v] : DBL_MAX), "dijkstra distance");
+        errors += check(paths[v].size() == (reachable ? expected[v] + 1 : 0), "dijkstra path");
+    }
+
+    // one parallel_bfs serving several sources
+    parallel_bfs shared(graph);
+    for (unsigned long source = 2; source <= 4; ++source)
+    {
+        dijkstra(graph, source, dist, paths, &shared);
+        reference_levels(graph, source, expected);
+        for (unsigned long v = 1; v<=n; ++v)
+            errors += check(dist[v] == (expected[v] != ULONG_MAX ? 3.0 * expected[v] : DBL_MAX), "reused bfs distance");
+    }
+    delete[] dist;
+    delete[] paths;
+
+    // a different weight met midway: the workspace search falls back to the heap
+    graph->get_vertex(1)->get_adjacencies()->set_weight(1);
+    errors += check(!uniform_weight(graph, &weight), "non-uniform weights");
+
+    sssp_workspace heap_ws(n);
+    dijkstra(graph, 2, &ws);
+    dijkstra_within_radius(graph, 2, DBL_MAX, &heap_ws);
+    for (unsigned long v = 1; v<=n; ++v)
+        errors += check(ws.get_distance(v) == heap_ws.get_distance(v), "fallback dijkstra");
+
+    delete graph;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
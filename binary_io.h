@@ -0,0 +1,42 @@
+#ifndef __BINARY_IO_H__
+#define __BINARY_IO_H__
+
+#include <vector>
+#include <cstdio>   // for fwrite, fread, fseek, ftell
+
+/* vectors in binary files: the size followed by the elements, as written by
+ * fwrite (hence files are not portable across architectures)
+ */
+
+template <class T>
+inline bool write_vector(FILE *fh, const std::vector<T> &v)
+{
+    unsigned long size = v.size();
+    if (fwrite(&size, sizeof(unsigned long), 1, fh) != 1)
+        return false;
+
+    return size == 0 || fwrite(&v[0], sizeof(T), size, fh) == size;
+}
+
+template <class T>
+inline bool read_vector(FILE *fh, std::vector<T> &v)
+{
+    unsigned long size;
+    if (fread(&size, sizeof(unsigned long), 1, fh) != 1)
+        return false;
+
+    // never trust the size beyond what is left in the file
+    long here = ftell(fh);
+    if (here < 0 || fseek(fh, 0, SEEK_END) != 0)
+        return false;
+    long end = ftell(fh);
+    if (end < here || fseek(fh, here, SEEK_SET) != 0)
+        return false;
+    if (size > (unsigned long) (end - here) / sizeof(T))
+        return false;
+
+    v.resize(size);
+    return size == 0 || fread(&v[0], sizeof(T), size, fh) == size;
+}
+
+#endif /* __BINARY_IO_H__ */
@@ -0,0 +1,670 @@
+#include "contraction.h"
+#include <omp.h>
+#include <cfloat>    // for DBL_MAX
+#include <cstdio>    // for fopen, fwrite, fread
+#include <cstring>   // for memcmp
+#include <algorithm>
+#include <utility>
+#include <iostream>
+#include "magical_config.h"
+#include "binary_io.h"
+
+#define ulong unsigned long
+
+/* witness searches give up after settling this many vertices, which may add
+ * superfluous shortcuts but never wrong ones
+ */
+#define WITNESS_SETTLE_LIMIT 500
+
+// identifies hierarchy files (and the version of their layout)
+#define CH_FILE_MAGIC "MAGICCH1"
+
+using namespace std;
+
+/*
+ * Auxiliary data structures: remaining graph during preprocessing
+ */
+
+typedef struct {
+    ulong other;    // head (in out-lists) or tail (in in-lists)
+    double weight;
+    ulong middle;   // bypassed vertex (0 for original arcs)
+} ch_arc;
+
+typedef struct {
+    ulong tail, head;
+    double weight;
+    ulong middle;
+} ch_shortcut;
+
+typedef struct {
+    vector< vector<ch_arc> > out, in;   // arcs among remaining vertices
+    vector<double> priority;
+    vector<ulong> deleted_neighbors;
+} ch_graph;
+
+/* inserts arc into list, or lowers the weight of an existing parallel one;
+ * returns false if the list already had an arc at least as short
+ */
+static bool merge_arc(vector<ch_arc> &list, ulong other, double weight, ulong middle)
+{
+    for (ulong i = 0; i<list.size(); ++i)
+    {
+        if (list[i].other == other)
+        {
+            if (list[i].weight <= weight)
+                return false;
+
+            list[i].weight = weight;
+            list[i].middle = middle;
+            return true;
+        }
+    }
+
+    ch_arc a = { other, weight, middle };
+    list.push_back(a);
+    return true;
+}
+
+/* shortcuts needed to contract 'v': one for each path u->v->x which is not
+ * dominated by a witness path from u to x avoiding v, and the vertices
+ * flagged in 'excluded' (if given): those contracted along with v, which
+ * would otherwise witness for each other
+ */
+static void find_shortcuts(ch_graph *g, ulong v, sssp_workspace *ws, vector<ch_shortcut> *shortcuts,
+    const vector<char> *excluded = 0)
+{
+    shortcuts->clear();
+
+    const vector<ch_arc> &in = g->in[v];
+    const vector<ch_arc> &out = g->out[v];
+    if (in.empty() || out.empty())
+        return;
+
+    double max_out = 0;
+    for (ulong j = 0; j<out.size(); ++j)
+        max_out = max(max_out, out[j].weight);
+
+    for (ulong i = 0; i<in.size(); ++i)
+    {
+        ulong u = in[i].other;
+        double bound = in[i].weight + max_out;
+
+        // local dijkstra from u, bounded by the longest path through v
+        ws->reset();
+        ws->add_source(u);
+
+        ulong num_settled = 0;
+        while (ws->has_next() && ws->next_key() <= bound && num_settled < WITNESS_SETTLE_LIMIT)
+        {
+            ulong a = ws->settle_next();
+            double da = ws->get_distance(a);
+            ++num_settled;
+
+            const vector<ch_arc> &adj = g->out[a];
+            for (ulong k = 0; k<adj.size(); ++k)
+                if (adj[k].other != v && !(excluded && (*excluded)[adj[k].other]))
+                    ws->relax(adj[k].other, da + adj[k].weight, a);
+        }
+
+        // any path found (even if not settled) is a valid witness
+        for (ulong j = 0; j<out.size(); ++j)
+        {
+            ulong x = out[j].other;
+            double through_v = in[i].weight + out[j].weight;
+
+            if (x != u && ws->get_distance(x) > through_v)
+            {
+                ch_shortcut s = { u, x, through_v, v };
+                shortcuts->push_back(s);
+            }
+        }
+    }
+}
+
+/* importance of a vertex: edge difference plus contracted neighbors (which
+ * spreads contraction uniformly over the graph)
+ */
+static void update_priority(ch_graph *g, ulong v, sssp_workspace *ws, vector<ch_shortcut> *buffer)
+{
+    find_shortcuts(g, v, ws, buffer);
+
+    g->priority[v] = (double) buffer->size() - (double) g->in[v].size()
+        - (double) g->out[v].size() + (double) g->deleted_neighbors[v];
+}
+
+// total order among vertices: by priority, ties broken by key
+static inline bool precedes(const ch_graph *g, ulong u, ulong v)
+{
+    return g->priority[u] < g->priority[v] || (g->priority[u] == g->priority[v] && u < v);
+}
+
+/*
+ * Contraction hierarchy implementation
+ */
+
+contraction_hierarchy::contraction_hierarchy()
+{
+    vertex_count = 0;
+    shortcut_count = 0;
+    forward = backward = 0;
+}
+
+contraction_hierarchy::~contraction_hierarchy()
+{
+    clear();
+}
+
+void contraction_hierarchy::clear()
+{
+    delete forward;
+    delete backward;
+    forward = backward = 0;
+
+    vertex_count = 0;
+    shortcut_count = 0;
+    rank.clear();
+    up_first.clear(); up_head.clear(); up_middle.clear(); up_weight.clear();
+    down_first.clear(); down_tail.clear(); down_middle.clear(); down_weight.clear();
+}
+
+bool contraction_hierarchy::build(AdjacencyList<> *graph)
+{
+    long num_vertices = graph->get_vertex_count();
+
+    // openmp setup
+    if ( !magical_config::load_settings("contraction", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    clear();
+
+    /* copy the graph, dropping loops and keeping only the shortest among
+     * parallel arcs ('slot' maps each head to its position in the out-list)
+     */
+    ch_graph g;
+    g.out.resize(num_vertices+1);
+    g.in.resize(num_vertices+1);
+    g.priority.assign(num_vertices+1, 0);
+    g.deleted_neighbors.assign(num_vertices+1, 0);
+
+    vector<ulong> slot(num_vertices+1, 0);
+    for (long u = 1; u <= num_vertices; ++u)
+    {
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ulong v = it->get_successor()->get_key();
+            double w = it->get_weight();
+
+            if (w < 0)
+            {
+                cerr << "[magical] graph given to contraction hierarchies has negative weights." << endl;
+                return false;
+            }
+
+            if (v != (ulong) u)
+            {
+                if (slot[v] != 0 && slot[v] <= g.out[u].size() && g.out[u][slot[v]-1].other == v)
+                    g.out[u][slot[v]-1].weight = min(g.out[u][slot[v]-1].weight, w);
+                else
+                {
+                    ch_arc a = { v, w, 0 };
+                    g.out[u].push_back(a);
+                    slot[v] = g.out[u].size();
+                }
+            }
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    for (long u = 1; u <= num_vertices; ++u)
+    {
+        for (ulong i = 0; i<g.out[u].size(); ++i)
+        {
+            ch_arc a = { (ulong) u, g.out[u][i].weight, 0 };
+            g.in[g.out[u][i].other].push_back(a);
+        }
+    }
+
+    // per-thread workspaces for witness searches
+    int num_threads = omp_get_max_threads();
+    vector<sssp_workspace*> ws(num_threads);
+    vector< vector<ch_shortcut> > buffer(num_threads);
+    for (int i = 0; i<num_threads; ++i)
+        ws[i] = new sssp_workspace(num_vertices);
+
+    // initial node ordering
+    #pragma omp parallel for default(none) shared(g, ws, buffer, num_vertices) schedule(dynamic, 64)
+    for (long v = 1; v <= num_vertices; ++v)
+    {
+        int thr = omp_get_thread_num();
+        update_priority(&g, v, ws[thr], &buffer[thr]);
+    }
+
+    vector<ulong> remaining;
+    for (long v = 1; v <= num_vertices; ++v)
+        remaining.push_back(v);
+
+    vector<bool> contracted(num_vertices+1, false);
+    vector<char> affected(num_vertices+1, 0), in_batch(num_vertices+1, 0);
+    vector< vector<ch_arc> > pending_out(num_vertices+1), pending_in(num_vertices+1);
+    rank.assign(num_vertices+1, 0);
+    ulong next_rank = 1;
+
+    /* contraction rounds: vertices preceding all of their neighbors form an
+     * independent set, so they can be contracted simultaneously
+     */
+    while (!remaining.empty())
+    {
+        long num_remaining = remaining.size();
+        vector<char> selected(num_remaining, 0);
+
+        #pragma omp parallel for default(none) shared(g, remaining, selected, num_remaining) schedule(static)
+        for (long i = 0; i < num_remaining; ++i)
+        {
+            ulong v = remaining[i];
+            bool minimal = true;
+
+            for (ulong k = 0; k<g.out[v].size() && minimal; ++k)
+                minimal = precedes(&g, v, g.out[v][k].other);
+            for (ulong k = 0; k<g.in[v].size() && minimal; ++k)
+                minimal = precedes(&g, v, g.in[v][k].other);
+
+            selected[i] = minimal;
+        }
+
+        vector<ulong> batch;
+        for (long i = 0; i < num_remaining; ++i)
+            if (selected[i])
+                batch.push_back(remaining[i]);
+
+        /* witness searches of the whole batch, on the graph as it is now: they
+         * avoid every batch vertex, all of which leave the graph together
+         */
+        long batch_size = batch.size();
+        vector< vector<ch_shortcut> > shortcuts(batch_size);
+        for (long i = 0; i < batch_size; ++i)
+            in_batch[batch[i]] = 1;
+
+        #pragma omp parallel for default(none) shared(g, ws, batch, batch_size, shortcuts, in_batch) schedule(dynamic, 16)
+        for (long i = 0; i < batch_size; ++i)
+            find_shortcuts(&g, batch[i], ws[omp_get_thread_num()], &shortcuts[i], &in_batch);
+
+        for (long i = 0; i < batch_size; ++i)
+            in_batch[batch[i]] = 0;
+
+        /* contract: the arcs still incident to each batch vertex lead to higher
+         * ranks and become its hierarchy arcs (its lists are not touched again)
+         */
+        vector<ulong> neighbors;
+        for (long i = 0; i < batch_size; ++i)
+        {
+            ulong v = batch[i];
+            rank[v] = next_rank++;
+            contracted[v] = true;
+
+            for (ulong k = 0; k<g.out[v].size(); ++k)
+            {
+                ulong x = g.out[v][k].other;
+                if (!affected[x]) { affected[x] = 1; neighbors.push_back(x); }
+            }
+            for (ulong k = 0; k<g.in[v].size(); ++k)
+            {
+                ulong x = g.in[v][k].other;
+                if (!affected[x]) { affected[x] = 1; neighbors.push_back(x); }
+            }
+
+            for (ulong k = 0; k<shortcuts[i].size(); ++k)
+            {
+                ch_shortcut &s = shortcuts[i][k];
+                ch_arc out_arc = { s.head, s.weight, s.middle };
+                ch_arc in_arc = { s.tail, s.weight, s.middle };
+                pending_out[s.tail].push_back(out_arc);
+                pending_in[s.head].push_back(in_arc);
+            }
+        }
+
+        // update neighbors: drop arcs to contracted vertices, merge shortcuts
+        long num_neighbors = neighbors.size();
+
+        #pragma omp parallel for default(none) shared(g, neighbors, num_neighbors, contracted, pending_out, pending_in) schedule(dynamic, 16)
+        for (long i = 0; i < num_neighbors; ++i)
+        {
+            ulong u = neighbors[i];
+            vector<ch_arc> *lists[2] = { &g.out[u], &g.in[u] };
+
+            for (int l = 0; l<2; ++l)
+            {
+                vector<ch_arc> &list = *lists[l];
+                ulong kept = 0;
+                for (ulong k = 0; k<list.size(); ++k)
+                {
+                    if (contracted[list[k].other])
+                        ++g.deleted_neighbors[u];
+                    else
+                        list[kept++] = list[k];
+                }
+                list.resize(kept);
+            }
+
+            for (ulong k = 0; k<pending_out[u].size(); ++k)
+                merge_arc(g.out[u], pending_out[u][k].other, pending_out[u][k].weight, pending_out[u][k].middle);
+            for (ulong k = 0; k<pending_in[u].size(); ++k)
+                merge_arc(g.in[u], pending_in[u][k].other, pending_in[u][k].weight, pending_in[u][k].middle);
+
+            pending_out[u].clear();
+            pending_in[u].clear();
+        }
+
+        // neighbors changed their surroundings: recompute their priorities
+        #pragma omp parallel for default(none) shared(g, ws, buffer, neighbors, num_neighbors, affected) schedule(dynamic, 16)
+        for (long i = 0; i < num_neighbors; ++i)
+        {
+            int thr = omp_get_thread_num();
+            update_priority(&g, neighbors[i], ws[thr], &buffer[thr]);
+            affected[neighbors[i]] = 0;
+        }
+
+        ulong kept = 0;
+        for (ulong i = 0; i<remaining.size(); ++i)
+            if (!contracted[remaining[i]])
+                remaining[kept++] = remaining[i];
+        remaining.resize(kept);
+    }
+
+    for (int i = 0; i<num_threads; ++i)
+        delete ws[i];
+
+    // compact search graph, from the frozen lists of each contracted vertex
+    vertex_count = num_vertices;
+    up_first.assign(num_vertices+2, 0);
+    down_first.assign(num_vertices+2, 0);
+
+    for (long v = 1; v <= num_vertices; ++v)
+    {
+        up_first[v+1] = up_first[v] + g.out[v].size();
+        down_first[v+1] = down_first[v] + g.in[v].size();
+
+        for (ulong k = 0; k<g.out[v].size(); ++k)
+        {
+            up_head.push_back(g.out[v][k].other);
+            up_weight.push_back(g.out[v][k].weight);
+            up_middle.push_back(g.out[v][k].middle);
+            if (g.out[v][k].middle != 0)
+                ++shortcut_count;
+        }
+
+        for (ulong k = 0; k<g.in[v].size(); ++k)
+        {
+            down_tail.push_back(g.in[v][k].other);
+            down_weight.push_back(g.in[v][k].weight);
+            down_middle.push_back(g.in[v][k].middle);
+            if (g.in[v][k].middle != 0)
+                ++shortcut_count;
+        }
+
+        vector<ch_arc>().swap(g.out[v]);
+        vector<ch_arc>().swap(g.in[v]);
+    }
+
+    forward = new sssp_workspace(vertex_count);
+    backward = new sssp_workspace(vertex_count);
+
+    return true;
+}
+
+double contraction_hierarchy::query(ulong s, ulong t, vector<ulong> *path)
+{
+    return query(s, t, path, forward, backward);
+}
+
+double contraction_hierarchy::query(ulong s, ulong t, vector<ulong> *path,
+    sssp_workspace *fwd, sssp_workspace *bwd)
+{
+    if (s < 1 || s > vertex_count)
+        throw NoSuchVertexException(s);
+    if (t < 1 || t > vertex_count)
+        throw NoSuchVertexException(t);
+
+    fwd->reset();
+    bwd->reset();
+    fwd->add_source(s);
+    bwd->add_source(t);
+
+    double best = DBL_MAX;
+    ulong meeting = 0;
+
+    /* bidirectional upward search: each side stops once its next vertex is
+     * not closer than the best meeting found so far
+     */
+    while (true)
+    {
+        bool fwd_open = fwd->has_next() && fwd->next_key() < best;
+        bool bwd_open = bwd->has_next() && bwd->next_key() < best;
+        if (!fwd_open && !bwd_open)
+            break;
+
+        // advance the side with the smallest key
+        bool forward_turn = fwd_open && (!bwd_open || fwd->next_key() <= bwd->next_key());
+        sssp_workspace *ws = forward_turn ? fwd : bwd;
+        sssp_workspace *other = forward_turn ? bwd : fwd;
+
+        ulong u = ws->settle_next();
+        double du = ws->get_distance(u);
+
+        if (other->get_distance(u) < DBL_MAX && du + other->get_distance(u) < best)
+        {
+            best = du + other->get_distance(u);
+            meeting = u;
+        }
+
+        /* stall-on-demand: if a higher vertex already reached by this search
+         * offers a shorter way to u, u cannot lie on a shortest up-down path
+         */
+        const vector<ulong> &opp_first = forward_turn ? down_first : up_first;
+        const vector<ulong> &opp_other = forward_turn ? down_tail : up_head;
+        const vector<double> &opp_weight = forward_turn ? down_weight : up_weight;
+
+        bool stalled = false;
+        for (ulong i = opp_first[u]; i<opp_first[u+1] && !stalled; ++i)
+        {
+            double dx = ws->get_distance(opp_other[i]);
+            stalled = (dx < DBL_MAX && dx + opp_weight[i] < du);
+        }
+
+        if (stalled)
+            continue;
+
+        const vector<ulong> &first = forward_turn ? up_first : down_first;
+        const vector<ulong> &next = forward_turn ? up_head : down_tail;
+        const vector<double> &weight = forward_turn ? up_weight : down_weight;
+
+        for (ulong i = first[u]; i<first[u+1]; ++i)
+            ws->relax(next[i], du + weight[i], u);
+    }
+
+    // path: s..meeting (forward predecessors), then meeting..t (backward ones)
+    if (path)
+    {
+        path->clear();
+        if (best < DBL_MAX)
+        {
+            vector<ulong> up_path;
+            fwd->get_path(meeting, &up_path);
+
+            path->push_back(s);
+            for (ulong i = 1; i<up_path.size(); ++i)
+                unpack(up_path[i-1], up_path[i], path);
+
+            for (ulong v = meeting; v != t; v = bwd->get_predecessor(v))
+                unpack(v, bwd->get_predecessor(v), path);
+        }
+    }
+
+    return best;
+}
+
+/* appends the original vertices of the hierarchy arc (a,b), except 'a', to the
+ * path
+ */
+void contraction_hierarchy::unpack(ulong a, ulong b, vector<ulong> *path) const
+{
+    vector< pair<ulong,ulong> > stack;
+    stack.push_back(make_pair(a, b));
+
+    while (!stack.empty())
+    {
+        ulong tail = stack.back().first;
+        ulong head = stack.back().second;
+        stack.pop_back();
+
+        ulong middle = 0;
+
+        // arcs are stored at their lower ranked endpoint
+        if (rank[tail] < rank[head])
+        {
+            for (ulong i = up_first[tail]; i<up_first[tail+1]; ++i)
+                if (up_head[i] == head)
+                    middle = up_middle[i];
+        }
+        else
+        {
+            for (ulong i = down_first[head]; i<down_first[head+1]; ++i)
+                if (down_tail[i] == tail)
+                    middle = down_middle[i];
+        }
+
+        if (middle == 0)
+            path->push_back(head);
+        else
+        {
+            // (tail,middle) is unpacked first
+            stack.push_back(make_pair(middle, head));
+            stack.push_back(make_pair(tail, middle));
+        }
+    }
+}
+
+/*
+ * Persistence: a magic string followed by the counters and every array, as
+ * written by fwrite (hence files are not portable across architectures)
+ */
+
+bool contraction_hierarchy::save(const char *filename) const
+{
+    FILE *fh = fopen(filename, "wb");
+    if (!fh)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        return false;
+    }
+
+    bool ok = fwrite(CH_FILE_MAGIC, 1, 8, fh) == 8
+        && fwrite(&vertex_count, sizeof(ulong), 1, fh) == 1
+        && fwrite(&shortcut_count, sizeof(ulong), 1, fh) == 1
+        && write_vector(fh, rank)
+        && write_vector(fh, up_first) && write_vector(fh, up_head)
+        && write_vector(fh, up_middle) && write_vector(fh, up_weight)
+        && write_vector(fh, down_first) && write_vector(fh, down_tail)
+        && write_vector(fh, down_middle) && write_vector(fh, down_weight);
+
+    ok = (fclose(fh) == 0) && ok;
+    if (!ok)
+        cerr << "[magical] could not write contraction hierarchy to " << filename << endl;
+
+    return ok;
+}
+
+/* checks a loaded forward star: offsets from 0 and nondecreasing, the other
+ * end of every arc a vertex of higher rank, middles 0 or of lower rank than
+ * both ends (so unpacking terminates), weights nonnegative
+ */
+static bool valid_star(const vector<ulong> &first, const vector<ulong> &other,
+                       const vector<ulong> &middle, const vector<double> &weight,
+                       const vector<ulong> &rank, ulong n)
+{
+    if (first[0] != 0 || first[1] != 0)
+        return false;
+
+    for (ulong v = 1; v <= n; ++v)
+    {
+        if (first[v+1] < first[v])
+            return false;
+
+        for (ulong i = first[v]; i < first[v+1]; ++i)
+        {
+            ulong u = other[i], m = middle[i];
+            if (u < 1 || u > n || rank[u] <= rank[v] || !(weight[i] >= 0))
+                return false;
+            if (m != 0 && (m > n || rank[m] >= rank[v]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool contraction_hierarchy::load(const char *filename)
+{
+    clear();
+
+    FILE *fh = fopen(filename, "rb");
+    if (!fh)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        return false;
+    }
+
+    char magic[8];
+    bool ok = fread(magic, 1, 8, fh) == 8 && memcmp(magic, CH_FILE_MAGIC, 8) == 0
+        && fread(&vertex_count, sizeof(ulong), 1, fh) == 1
+        && fread(&shortcut_count, sizeof(ulong), 1, fh) == 1
+        && read_vector(fh, rank)
+        && read_vector(fh, up_first) && read_vector(fh, up_head)
+        && read_vector(fh, up_middle) && read_vector(fh, up_weight)
+        && read_vector(fh, down_first) && read_vector(fh, down_tail)
+        && read_vector(fh, down_middle) && read_vector(fh, down_weight);
+    fclose(fh);
+
+    // consistency of the forward stars
+    ok = ok && rank.size() == vertex_count+1
+        && up_first.size() == vertex_count+2 && down_first.size() == vertex_count+2
+        && up_first[vertex_count+1] == up_head.size() && up_head.size() == up_weight.size()
+        && up_head.size() == up_middle.size()
+        && down_first[vertex_count+1] == down_tail.size() && down_tail.size() == down_weight.size()
+        && down_tail.size() == down_middle.size();
+
+    // indices must stay in range before any query may follow them
+    ok = ok && valid_star(up_first, up_head, up_middle, up_weight, rank, vertex_count)
+        && valid_star(down_first, down_tail, down_middle, down_weight, rank, vertex_count);
+
+    if (!ok)
+    {
+        cerr << "[magical] invalid contraction hierarchy file " << filename << endl;
+        clear();
+        return false;
+    }
+
+    forward = new sssp_workspace(vertex_count);
+    backward = new sssp_workspace(vertex_count);
+
+    return true;
+}
+
+unsigned long contraction_hierarchy::get_vertex_count() const { return vertex_count; }
+
+unsigned long contraction_hierarchy::get_shortcut_count() const { return shortcut_count; }
+
+unsigned long contraction_hierarchy::get_rank(ulong v) const
+{
+    if (v < 1 || v > vertex_count)
+        throw NoSuchVertexException(v);
+
+    return rank[v];
+}
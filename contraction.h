@@ -0,0 +1,67 @@
+#ifndef __CONTRACTION_H__
+#define __CONTRACTION_H__
+
+#include <vector>
+#include "types.h"
+#include "sssp_workspace.h"
+
+/**
+ * contraction_hierarchy: preprocessing and query engine for point-to-point
+ * shortest paths on static graphs with nonnegative weights (Geisberger et al.
+ * 2008). Vertices are contracted in order of importance, adding shortcuts which
+ * preserve distances among the remaining ones; queries then run a bidirectional
+ * Dijkstra visiting only arcs toward more important vertices.
+ *
+ * The hierarchy is independent of the graph once built, and may be saved to
+ * (and loaded from) a file so that preprocessing is amortized across runs.
+ */
+class contraction_hierarchy
+{
+public:
+    // constructor and destructor
+    contraction_hierarchy();
+    virtual ~contraction_hierarchy();
+
+    /* orders and contracts every vertex (in parallel rounds of independent
+     * vertices); returns false if the graph has negative weights
+     */
+    bool build(AdjacencyList<>*);
+
+    /* s->t distance (DBL_MAX if unreachable), storing the path in the original
+     * graph if requested (may be 0). Uses workspaces owned by the hierarchy, so
+     * concurrent queries must use the overload below with their own ones
+     */
+    double query(unsigned long, unsigned long, std::vector<unsigned long>*);
+    double query(unsigned long, unsigned long, std::vector<unsigned long>*, sssp_workspace*, sssp_workspace*);
+
+    // persistence: return false on I/O errors (or invalid file, when loading)
+    bool save(const char*) const;
+    bool load(const char*);
+
+    // structure access (get)
+    unsigned long get_vertex_count() const;
+    unsigned long get_shortcut_count() const;
+    unsigned long get_rank(unsigned long) const;   // contraction order, from 1
+
+private:
+    void unpack(unsigned long, unsigned long, std::vector<unsigned long>*) const;
+    void clear();
+
+    unsigned long vertex_count;
+    unsigned long shortcut_count;
+    std::vector<unsigned long> rank;
+
+    /* search graph (forward star): 'up' holds, for each vertex, the arcs leaving
+     * it toward higher ranks; 'down' holds the arcs entering it from higher ranks,
+     * i.e. 'down_tail[i]' -> vertex. 'middle' is the contracted vertex a shortcut
+     * bypasses (0 for original arcs)
+     */
+    std::vector<unsigned long> up_first, up_head, up_middle;
+    std::vector<double> up_weight;
+    std::vector<unsigned long> down_first, down_tail, down_middle;
+    std::vector<double> down_weight;
+
+    sssp_workspace *forward, *backward;
+};
+
+#endif /* __CONTRACTION_H__ */
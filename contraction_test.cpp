@@ -0,0 +1,215 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cfloat>
+#include "types.h"
+#include "paths.h"
+#include "contraction.h"
+
+#include <sys/time.h>       // for 'gettimeofday()'
+
+#define NUM_QUERIES 200
+
+using namespace std;
+
+// -- time evaluation functions ------------------------------------------------
+
+double wall_time()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1.e-6 * t.tv_usec;
+}
+
+// -----------------------------------------------------------------------------
+
+/* copies the first 'length' bytes of file 'from' to 'to', overwriting the
+ * unsigned long at byte 'offset' with 'value' when 'offset' is not negative
+ */
+bool corruptCopy(const char *from, const char *to, long length, long offset, unsigned long value)
+{
+    FILE *in = fopen(from, "rb");
+    if (!in)
+        return false;
+    vector<char> bytes(length);
+    bool ok = fread(&bytes[0], 1, length, in) == (size_t) length;
+    fclose(in);
+
+    if (offset >= 0)
+        *(unsigned long*) &bytes[offset] = value;
+
+    FILE *out = fopen(to, "wb");
+    if (!out)
+        return false;
+    ok = fwrite(&bytes[0], 1, length, out) == (size_t) length && ok;
+    return (fclose(out) == 0) && ok;
+}
+
+// road-like instance: side x side grid, with both arcs of each street
+AdjacencyList<>* gridGraph(unsigned long side, unsigned long range)
+{
+    AdjacencyList<> *grid = new AdjacencyList<>(side*side);
+
+    srand(1234567);
+
+    for (unsigned long r = 0; r<side; ++r)
+    {
+        for (unsigned long c = 0; c<side; ++c)
+        {
+            unsigned long v = r*side + c + 1;
+            if (c+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v, v+1, w);
+                grid->addEdge(v+1, v, w);
+            }
+            if (r+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v, v+side, w);
+                grid->addEdge(v+side, v, w);
+            }
+        }
+    }
+
+    return grid;
+}
+
+// total weight of a path, using the cheapest arc between consecutive vertices
+double path_weight(AdjacencyList<> *g, const vector<unsigned long> &path)
+{
+    double total = 0;
+    for (unsigned long i = 1; i<path.size(); ++i)
+    {
+        Edge *e = g->isEdge(path[i-1], path[i]);
+        total += e ? e->get_weight() : DBL_MAX;
+    }
+
+    return total;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    unsigned long side = (argc > 1) ? atol(argv[1]) : 100;
+    AdjacencyList<> *graph = gridGraph(side, 100);
+    unsigned long num_vertices = graph->get_vertex_count();
+
+    contraction_hierarchy ch;
+    double start = wall_time();
+    if (!ch.build(graph))
+    {
+        cerr << "build returned false" << endl;
+        return 1;
+    }
+    printf("preprocessing: %.6f (%lu shortcuts)\n", wall_time() - start, ch.get_shortcut_count());
+
+    // persistence round trip: queries below run on the loaded hierarchy
+    contraction_hierarchy loaded;
+    if (!ch.save("/tmp/magical_ch.bin") || !loaded.load("/tmp/magical_ch.bin"))
+    {
+        cerr << "save/load failed" << endl;
+        return 1;
+    }
+
+    int mismatches = 0;
+
+    // truncated or corrupted files must be rejected, not trusted
+    {
+        FILE *fh = fopen("/tmp/magical_ch.bin", "rb");
+        fseek(fh, 0, SEEK_END);
+        long length = ftell(fh);
+        fclose(fh);
+
+        // layout: magic, the two counters, rank, up_first, then up_head
+        long rank_at = 8 + 2*sizeof(unsigned long);
+        long head_at = rank_at + (num_vertices+2)*sizeof(unsigned long)
+            + (num_vertices+3)*sizeof(unsigned long) + sizeof(unsigned long);
+
+        const char *bad = "/tmp/magical_ch_bad.bin";
+        contraction_hierarchy rejected;
+        if (!corruptCopy("/tmp/magical_ch.bin", bad, length/2, -1, 0) || rejected.load(bad))
+        {
+            cout << "truncated file accepted" << endl;
+            ++mismatches;
+        }
+        if (!corruptCopy("/tmp/magical_ch.bin", bad, length, rank_at, (unsigned long) -1 / 16)
+            || rejected.load(bad))
+        {
+            cout << "oversized vector accepted" << endl;
+            ++mismatches;
+        }
+        if (!corruptCopy("/tmp/magical_ch.bin", bad, length, head_at, num_vertices+1)
+            || rejected.load(bad))
+        {
+            cout << "out of range head accepted" << endl;
+            ++mismatches;
+        }
+        remove(bad);
+    }
+
+    sssp_workspace ws(num_vertices);
+    double dijkstra_time = 0, ch_time = 0;
+
+    srand(7654321);
+    for (int q = 0; q < NUM_QUERIES; ++q)
+    {
+        unsigned long s = (rand() % num_vertices) + 1;
+        unsigned long t = (rand() % num_vertices) + 1;
+
+        vector<unsigned long> targets(1, t);
+        start = wall_time();
+        dijkstra_to_targets(graph, s, targets, &ws);
+        dijkstra_time += wall_time() - start;
+
+        vector<unsigned long> path;
+        start = wall_time();
+        double d = loaded.query(s, t, &path);
+        ch_time += wall_time() - start;
+
+        if (d != ws.get_distance(t) || path.front() != s || path.back() != t
+            || path_weight(graph, path) != d)
+        {
+            cout << "mismatch " << s << " -> " << t << ": ch " << d
+                << " dijkstra " << ws.get_distance(t) << endl;
+            ++mismatches;
+        }
+    }
+
+    /* 4-cycle 1-3-2-4-1: 1 and 2 are contracted in the same batch, and each
+     * used to witness for the other, leaving 3 and 4 disconnected
+     */
+    AdjacencyList<> *cycle = new AdjacencyList<>(4);
+    unsigned long ring[5] = { 1, 3, 2, 4, 1 };
+    for (int i = 0; i < 4; ++i)
+    {
+        cycle->addEdge(ring[i], ring[i+1], 1);
+        cycle->addEdge(ring[i+1], ring[i], 1);
+    }
+
+    contraction_hierarchy small;
+    small.build(cycle);
+    sssp_workspace small_ws(4);
+    for (unsigned long s = 1; s <= 4; ++s)
+    {
+        dijkstra(cycle, s, &small_ws);
+        for (unsigned long t = 1; t <= 4; ++t)
+        {
+            if (small.query(s, t, 0) != small_ws.get_distance(t))
+            {
+                cout << "mismatch on the 4-cycle " << s << " -> " << t << endl;
+                ++mismatches;
+            }
+        }
+    }
+    delete cycle;
+
+    printf("dijkstra: %.6f\nch:       %.6f\n", dijkstra_time, ch_time);
+    cout << mismatches << " mismatches in " << NUM_QUERIES << " queries" << endl;
+
+    delete graph;
+
+    return mismatches;
+}
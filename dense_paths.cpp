@@ -0,0 +1,152 @@
+#include "dense_paths.h"
+#include "analysis.h"
+#include <cmath>     // for HUGE_VAL
+#include <cstdlib>   // for atol, atof
+#include <algorithm>
+#include "magical_config.h"
+#ifdef __AVX2__
+#include <immintrin.h>   // fused relaxation and selection
+#endif
+
+#define ulong unsigned long
+
+using namespace std;
+
+/*
+ * Dense Dijkstra's implementation
+ */
+
+dense_dijkstra::dense_dijkstra(AdjacencyList<> *graph, const double *potential)
+{
+    vertex_count = graph->get_vertex_count();
+    stride = (vertex_count + 4) & ~3UL;   // column 0 unused, rows padded to whole vectors
+
+    weight.assign(stride * (vertex_count+1), HUGE_VAL);
+
+    for (ulong u = 1; u<=vertex_count; ++u)
+    {
+        double *row = &weight[u * stride];
+
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ulong v = it->get_successor()->get_key();
+            double w = it->get_weight();
+
+            // reduced cost (nonnegative, but for rounding)
+            if (potential)
+                w = max(0.0, w + potential[u] - potential[v]);
+
+            row[v] = min(row[v], w);
+            it = it->get_next();   // next edge
+        }
+    }
+}
+
+dense_dijkstra::~dense_dijkstra() { }
+
+void dense_dijkstra::run(ulong source, sssp_workspace *ws) const throw (NoSuchVertexException)
+{
+    if (source < 1 || source > vertex_count)
+        throw NoSuchVertexException(source);
+
+    /* tentative distances, and the same as selection keys where settled
+     * vertices (and padding) hold HUGE_VAL. Settled vertices need no flag in
+     * the relaxation: their distance is at most the current one, which no
+     * arc (of nonnegative weight) improves
+     */
+    vector<double> dist(stride, HUGE_VAL), key(stride, HUGE_VAL);
+    vector<ulong> pred(stride, 0);
+
+    ws->reset();
+    dist[source] = 0;
+
+    for (ulong u = source; ; )
+    {
+        ws->settle(u, dist[u], pred[u]);
+        key[u] = HUGE_VAL;
+
+        const double *row = &weight[u * stride];
+        double du = dist[u];
+        double best = HUGE_VAL;
+        ulong next = 0;
+        ulong j = 0;
+
+#if defined(__AVX2__) && __SIZEOF_LONG__ == 8
+        // four columns at a time: relax, then keep the smallest key of each lane
+        __m256d vu = _mm256_set1_pd(du);
+        __m256d vpred = _mm256_castsi256_pd(_mm256_set1_epi64x(u));
+        __m256d vbest = _mm256_set1_pd(HUGE_VAL);
+        __m256d vindex = _mm256_setr_pd(0, 1, 2, 3), vnext = vindex;
+        __m256d four = _mm256_set1_pd(4);
+
+        for (; j < stride; j += 4)
+        {
+            __m256d d = _mm256_add_pd(vu, _mm256_loadu_pd(row + j));
+            __m256d dj = _mm256_loadu_pd(&dist[j]);
+            __m256d less = _mm256_cmp_pd(d, dj, _CMP_LT_OQ);
+
+            _mm256_storeu_pd(&dist[j], _mm256_blendv_pd(dj, d, less));
+            __m256d kj = _mm256_blendv_pd(_mm256_loadu_pd(&key[j]), d, less);
+            _mm256_storeu_pd(&key[j], kj);
+
+            __m256d pj = _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i*) &pred[j]));
+            _mm256_storeu_si256((__m256i*) &pred[j], _mm256_castpd_si256(_mm256_blendv_pd(pj, vpred, less)));
+
+            __m256d smaller = _mm256_cmp_pd(kj, vbest, _CMP_LT_OQ);
+            vbest = _mm256_blendv_pd(vbest, kj, smaller);
+            vnext = _mm256_blendv_pd(vnext, vindex, smaller);
+            vindex = _mm256_add_pd(vindex, four);
+        }
+
+        double lane_best[4], lane_next[4];
+        _mm256_storeu_pd(lane_best, vbest);
+        _mm256_storeu_pd(lane_next, vnext);
+        for (int l = 0; l<4; ++l)
+        {
+            if (lane_best[l] < best)
+            {
+                best = lane_best[l];
+                next = (ulong) lane_next[l];
+            }
+        }
+#endif
+        for (; j < stride; ++j)
+        {
+            double d = du + row[j];
+            if (d < dist[j])
+            {
+                dist[j] = key[j] = d;
+                pred[j] = u;
+            }
+
+            if (key[j] < best)
+            {
+                best = key[j];
+                next = j;
+            }
+        }
+
+        if (best == HUGE_VAL)
+            break;   // every reachable vertex is settled
+
+        u = next;
+    }
+}
+
+bool prefer_dense_dijkstra(AdjacencyList<> *graph)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    if (num_vertices < 2)
+        return false;
+
+    // the n x n weight matrix must be affordable
+    string max_size = magical_config::get_setting("dense", "max_size");
+    if (num_vertices > (max_size.empty() ? 8000 : (ulong) atol(max_size.c_str())))
+        return false;
+
+    string min_density = magical_config::get_setting("dense", "min_density");
+    double threshold = min_density.empty() ? 0.2 : atof(min_density.c_str());
+
+    return analyze_graph(graph).arc_count >= threshold * num_vertices * (num_vertices - 1);
+}
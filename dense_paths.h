@@ -0,0 +1,46 @@
+#ifndef __DENSE_PATHS_H__
+#define __DENSE_PATHS_H__
+
+#include <vector>
+#include "types.h"
+#include "sssp_workspace.h"
+
+/**
+ * dense_dijkstra: Dijkstra's algorithm in O(n^2) on a weight matrix, for
+ * dense graphs (e.g. complete TSPLIB instances), where the heap would take a
+ * decrease-key on nearly every arc. Each step makes one pass over the row of
+ * the vertex just settled, fusing the relaxation of its arcs with the choice
+ * of the next vertex (the smallest tentative distance); with AVX2 the pass
+ * runs four columns at a time.
+ *
+ * The constructor builds the matrix (the cheapest of parallel arcs, n^2
+ * doubles), which is only read afterwards, so one instance may serve
+ * concurrent searches from many sources. Building it costs about as much as
+ * a search, so it pays off over many sources (as in johnson()), not for one.
+ * Weights must be nonnegative, unless potentials making them so are given
+ * (as in Johnson's algorithm), in which case searches give reduced distances.
+ */
+class dense_dijkstra
+{
+public:
+    // constructor: weights w(u,v), or w(u,v) + h[u] - h[v] for potentials h
+    dense_dijkstra(AdjacencyList<>*, const double* = 0);
+    virtual ~dense_dijkstra();
+
+    /* single-source search, results left in the workspace (reset first) with
+     * vertices settled by nondecreasing distance
+     */
+    void run(unsigned long, sssp_workspace*) const throw (NoSuchVertexException);
+
+private:
+    unsigned long vertex_count, stride;
+    std::vector<double> weight;   // row u at u*stride, column v at v (HUGE_VAL: no arc)
+};
+
+/* whether dense_dijkstra pays off: the arcs fill at least min_density of the
+ * matrix and n is at most max_size, both from dense_dijkstra in
+ * magical_config (0.2 and 8000 by default). Weights are not checked
+ */
+bool prefer_dense_dijkstra(AdjacencyList<>*);
+
+#endif /* __DENSE_PATHS_H__ */
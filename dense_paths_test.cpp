@@ -0,0 +1,115 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <cmath>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "analysis.h"
+#include "dense_paths.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// complete graph with random real weights in [1..range]
+AdjacencyList<>* completeGraph(unsigned long num_vertices, unsigned long range)
+{
+    AdjacencyList<> *g = new AdjacencyList<>(num_vertices);
+
+    srand(1234567);
+
+    for (unsigned long i=1; i<=num_vertices; ++i)
+        for (unsigned long j=1; j<=num_vertices; ++j)
+            if (i != j)
+                g->addEdge(i, j, 1 + (rand() % (100*range)) / 100.0);
+
+    return g;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 1501;   // rows end with a partial vector
+    AdjacencyList<> *graph = completeGraph(n, 1000);
+
+    errors += check(prefer_dense_dijkstra(graph), "dense graph detected");
+
+    dense_dijkstra dense(graph);
+    sssp_workspace ws(n), heap_ws(n);
+    double dense_time = 0, heap_time = 0;
+
+    for (unsigned long source = 1; source <= 20; ++source)
+    {
+        double start = omp_get_wtime();
+        dense.run(source, &ws);
+        dense_time += omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        dijkstra_within_radius(graph, source, DBL_MAX, &heap_ws);
+        heap_time += omp_get_wtime() - start;
+
+        for (unsigned long v = 1; v<=n; ++v)
+        {
+            errors += check(ws.get_distance(v) == heap_ws.get_distance(v), "dense distance");
+
+            // predecessors: a tight arc
+            unsigned long p = ws.get_predecessor(v);
+            if (v != source)
+                errors += check(p != 0 && ws.get_distance(p) + graph->isEdge(p, v)->get_weight() == ws.get_distance(v),
+                    "dense predecessor");
+        }
+
+        // settled in nondecreasing distance
+        const vector<unsigned long> &settled = ws.get_settled();
+        errors += check(settled.size() == n && settled[0] == source, "dense settled");
+        for (unsigned long k = 1; k<settled.size(); ++k)
+            errors += check(ws.get_distance(settled[k-1]) <= ws.get_distance(settled[k]), "dense settled order");
+    }
+
+    cout << "20 sources: dense " << dense_time << "s, heap " << heap_time << "s" << endl;
+
+    // single-source calls keep to the heap kernels, against the same distances
+    dense.run(7, &ws);
+    shortest_paths(graph, 7, &heap_ws);
+    for (unsigned long v = 1; v<=n; ++v)
+        errors += check(heap_ws.get_distance(v) == ws.get_distance(v), "dispatched distance");
+
+    // unreachable vertices and negative arcs: johnson on reduced costs against bellman-ford
+    unsigned long m = 300;
+    AdjacencyList<> *small = completeGraph(m, 50);
+    AdjacencyList<> *isolated = new AdjacencyList<>(m+1);
+    for (unsigned long u = 1; u<=m; ++u)
+        for (Edge* it = small->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+        {
+            unsigned long v = it->get_successor()->get_key();
+            isolated->addEdge(u, v, it->get_weight() + 3.0 * (u % 7) - 3.0 * (v % 7));   // reweighted: no negative cycle
+        }
+
+    AllPairsResult<> result(m+1);
+    errors += check(johnson(isolated, &result), "johnson on a dense graph");
+
+    vector<double> bf_dist(m+2);
+    vector<unsigned long> bf_pred(m+2);
+    for (unsigned long u = 1; u<=m+1; ++u)
+    {
+        bellman_ford(isolated, u, &bf_dist[0], &bf_pred[0]);
+        for (unsigned long v = 1; v<=m+1; ++v)
+        {
+            double d = result.distance(u, v);
+            errors += check(bf_dist[v] == DBL_MAX ? d == AllPairsResult<>::infinity() : fabs(d - bf_dist[v]) < 1e-9,
+                "johnson dense distance");
+        }
+    }
+
+    delete graph;
+    delete small;
+    delete isolated;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
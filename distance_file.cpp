@@ -0,0 +1,225 @@
+#include "distance_file.h"
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>      // for open
+#include <unistd.h>     // for ftruncate, close, sysconf
+#include <sys/mman.h>   // for mmap, msync, madvise
+#include <sys/stat.h>   // for fstat
+
+#define ulong unsigned long
+
+#define DM_FILE_MAGIC "MAGICDM1"
+#define DM_HEADER_SIZE 4096   // one page, so the matrix is page-aligned
+
+using namespace std;
+
+/* position (in doubles, after the header) of entry (u,v): tiles in row-major
+ * order, then row-major inside the tile
+ */
+static size_t tiled_index(ulong u, ulong v, ulong tile, ulong tiles_per_side)
+{
+    size_t tile_row = (u-1) / tile, tile_col = (v-1) / tile;
+    size_t first = (tile_row * tiles_per_side + tile_col) * tile * tile;
+
+    return first + ((u-1) % tile) * tile + (v-1) % tile;
+}
+
+/*
+ * Writer implementation
+ */
+
+distance_file_writer::distance_file_writer()
+{
+    fd = -1;
+    map = 0;
+    map_size = 0;
+    vertex_count = tile = tiles_per_side = 0;
+    failed = false;
+}
+
+distance_file_writer::~distance_file_writer()
+{
+    close();
+}
+
+bool distance_file_writer::create(const char *filename, ulong num_vertices, ulong tile_side)
+{
+    close();
+
+    vertex_count = num_vertices;
+    tile = (tile_side == 0) ? 64 : tile_side;
+    tiles_per_side = (num_vertices + tile - 1) / tile;
+    band_rows.assign(tiles_per_side, 0);
+    failed = false;
+
+    map_size = DM_HEADER_SIZE + (size_t) tiles_per_side * tiles_per_side * tile * tile * sizeof(double);
+
+    fd = ::open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, map_size) != 0)
+    {
+        cerr << "[magical] could not create file " << filename << endl;
+        close();
+        return false;
+    }
+
+    void *m = mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED)
+    {
+        cerr << "[magical] could not map file " << filename << endl;
+        close();
+        return false;
+    }
+    map = (char*) m;
+
+    memcpy(map, DM_FILE_MAGIC, 8);
+    memcpy(map + 8, &vertex_count, sizeof(ulong));
+    memcpy(map + 8 + sizeof(ulong), &tile, sizeof(ulong));
+
+    return true;
+}
+
+void distance_file_writer::store_row(ulong u, const double *d, const ulong*)
+{
+    if (!map || u < 1 || u > vertex_count)
+    {
+        failed = true;
+        return;
+    }
+
+    // tile by tile: 'tile' contiguous entries each
+    double *matrix = (double*) (map + DM_HEADER_SIZE);
+    for (ulong v = 1; v<=vertex_count; v += tile)
+    {
+        ulong count = min(tile, vertex_count - v + 1);
+        memcpy(&matrix[tiled_index(u, v, tile, tiles_per_side)], d + v, count * sizeof(double));
+    }
+
+    // the last row of a band flushes it, releasing its pages
+    ulong band = (u-1) / tile;
+    ulong band_size = min(tile, vertex_count - band * tile);
+    ulong stored;
+
+    #pragma omp critical(distance_file_writer)
+    stored = ++band_rows[band];
+
+    if (stored == band_size)
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t first = DM_HEADER_SIZE + (size_t) band * tiles_per_side * tile * tile * sizeof(double);
+        size_t last = first + (size_t) tiles_per_side * tile * tile * sizeof(double);
+        first -= first % page;
+
+        // shared mappings keep dirty pages in the page cache once released
+        if (msync(map + first, last - first, MS_ASYNC) != 0
+            || madvise(map + first, last - first, MADV_DONTNEED) != 0)
+            failed = true;
+    }
+}
+
+bool distance_file_writer::close()
+{
+    bool ok = !failed;
+
+    if (map)
+    {
+        ok = msync(map, map_size, MS_SYNC) == 0 && ok;
+        munmap(map, map_size);
+        map = 0;
+    }
+
+    if (fd >= 0)
+    {
+        ok = ::close(fd) == 0 && ok;
+        fd = -1;
+    }
+
+    return ok;
+}
+
+/*
+ * Reader implementation
+ */
+
+distance_file::distance_file()
+{
+    fd = -1;
+    map = 0;
+    map_size = 0;
+    vertex_count = tile = tiles_per_side = 0;
+}
+
+distance_file::~distance_file()
+{
+    close();
+}
+
+bool distance_file::open(const char *filename)
+{
+    close();
+
+    struct stat st;
+    fd = ::open(filename, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        close();
+        return false;
+    }
+
+    map_size = st.st_size;
+    void *m = (map_size >= DM_HEADER_SIZE) ? mmap(0, map_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (m == MAP_FAILED)
+    {
+        cerr << "[magical] could not map file " << filename << endl;
+        close();
+        return false;
+    }
+    map = (const char*) m;
+
+    // lookups are random: no read-ahead
+    madvise((void*) map, map_size, MADV_RANDOM);
+
+    memcpy(&vertex_count, map + 8, sizeof(ulong));
+    memcpy(&tile, map + 8 + sizeof(ulong), sizeof(ulong));
+    tiles_per_side = (tile == 0) ? 0 : (vertex_count + tile - 1) / tile;
+
+    if (memcmp(map, DM_FILE_MAGIC, 8) != 0 || tile == 0
+        || map_size != DM_HEADER_SIZE + (size_t) tiles_per_side * tiles_per_side * tile * tile * sizeof(double))
+    {
+        cerr << "[magical] invalid distance file " << filename << endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void distance_file::close()
+{
+    if (map)
+    {
+        munmap((void*) map, map_size);
+        map = 0;
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    vertex_count = 0;
+}
+
+ulong distance_file::get_vertex_count() const { return vertex_count; }
+
+double distance_file::distance(ulong u, ulong v) const throw (NoSuchVertexException)
+{
+    if (u < 1 || u > vertex_count)
+        throw NoSuchVertexException(u);
+    if (v < 1 || v > vertex_count)
+        throw NoSuchVertexException(v);
+
+    const double *matrix = (const double*) (map + DM_HEADER_SIZE);
+    return matrix[tiled_index(u, v, tile, tiles_per_side)];
+}
@@ -0,0 +1,74 @@
+#ifndef __DISTANCE_FILE_H__
+#define __DISTANCE_FILE_H__
+
+#include <cstddef>
+#include "types.h"
+#include "paths.h"
+
+/**
+ * Out-of-core all-pairs distances: an n x n matrix of doubles kept in a file
+ * and accessed through mmap, so neither writing nor reading it needs the whole
+ * matrix in memory.
+ *
+ * The file starts with a header page (magic "MAGICDM1", vertex count and tile
+ * side). The matrix follows in square tiles, stored row-major (both the tiles
+ * and the entries in each tile, edge tiles padded to full size), so that the
+ * rows of a band of tiles are contiguous and a lookup touches a single page.
+ * Unreachable pairs hold DBL_MAX. Files are written by mmap (hence are not
+ * portable across architectures).
+ */
+
+/* row sink filling a distance file, e.g. johnson(graph, &writer). Each band of
+ * rows is flushed and released from memory as soon as all its rows arrive
+ */
+class distance_file_writer : public apsp_row_sink
+{
+public:
+    // constructor and destructor (which closes the file)
+    distance_file_writer();
+    virtual ~distance_file_writer();
+
+    /* creates the file for the given number of vertices and tile side; returns
+     * false on I/O errors
+     */
+    bool create(const char*, unsigned long, unsigned long = 64);
+
+    void store_row(unsigned long, const double*, const unsigned long*);
+
+    // flushes and unmaps the file; false if any step (or row) failed
+    bool close();
+
+private:
+    int fd;
+    char *map;
+    size_t map_size;
+    unsigned long vertex_count, tile, tiles_per_side;
+    std::vector<unsigned long> band_rows;   // rows stored so far, per band
+    bool failed;
+};
+
+/* random access to a distance file */
+class distance_file
+{
+public:
+    // constructor and destructor (which closes the file)
+    distance_file();
+    virtual ~distance_file();
+
+    // maps an existing file; returns false on I/O errors or invalid files
+    bool open(const char*);
+    void close();
+
+    unsigned long get_vertex_count() const;
+
+    // d(u,v), DBL_MAX if v is unreachable from u
+    double distance(unsigned long, unsigned long) const throw (NoSuchVertexException);
+
+private:
+    int fd;
+    const char *map;
+    size_t map_size;
+    unsigned long vertex_count, tile, tiles_per_side;
+};
+
+#endif /* __DISTANCE_FILE_H__ */
@@ -0,0 +1,174 @@
+#include "distance_oracle.h"
+#include "paths.h"
+#include <cfloat>   // for DBL_MAX
+#include <algorithm>
+
+#define ulong unsigned long
+
+using namespace std;
+
+distance_oracle::distance_oracle(AdjacencyList<> *g, size_t memory_budget)
+{
+    graph = g;
+    vertex_count = g->get_vertex_count();
+
+    size_t row_size = (vertex_count+1) * (sizeof(double) + sizeof(unsigned int));
+    capacity = max((size_t) 1, memory_budget / row_size);
+
+    rows.assign(vertex_count+1, (row*) 0);
+    position.resize(vertex_count+1);
+    cached = hits = misses = 0;
+
+    omp_init_lock(&lock);
+}
+
+distance_oracle::~distance_oracle()
+{
+    clear();
+    omp_destroy_lock(&lock);
+}
+
+/* full single-source row of 'source' (run without the lock) */
+distance_oracle::row* distance_oracle::compute(ulong source) const
+{
+    sssp_workspace ws(vertex_count);
+    dijkstra(graph, source, &ws);
+
+    row *r = new row;
+    r->dist.resize(vertex_count+1);
+    r->pred.resize(vertex_count+1);
+
+    for (ulong v = 1; v<=vertex_count; ++v)
+    {
+        r->dist[v] = ws.get_distance(v);
+        r->pred[v] = ws.get_predecessor(v);
+    }
+
+    return r;
+}
+
+/* cached row of 'source', computing it on a miss; the caller must release the
+ * lock once done reading the row
+ */
+const distance_oracle::row* distance_oracle::acquire(ulong source)
+{
+    omp_set_lock(&lock);
+
+    if (rows[source])
+    {
+        ++hits;
+        recent.splice(recent.begin(), recent, position[source]);   // most recent
+        return rows[source];
+    }
+
+    ++misses;
+    omp_unset_lock(&lock);
+
+    row *r = compute(source);
+
+    omp_set_lock(&lock);
+
+    // another thread may have cached the same row meanwhile
+    if (rows[source])
+    {
+        delete r;
+        recent.splice(recent.begin(), recent, position[source]);
+        return rows[source];
+    }
+
+    // evict least recently used rows
+    while (cached >= capacity)
+    {
+        ulong victim = recent.back();
+        recent.pop_back();
+        delete rows[victim];
+        rows[victim] = 0;
+        --cached;
+    }
+
+    rows[source] = r;
+    recent.push_front(source);
+    ++cached;
+    position[source] = recent.begin();
+
+    return r;
+}
+
+double distance_oracle::distance(ulong u, ulong v) throw (NoSuchVertexException)
+{
+    if (u < 1 || u > vertex_count)
+        throw NoSuchVertexException(u);
+    if (v < 1 || v > vertex_count)
+        throw NoSuchVertexException(v);
+
+    const row *r = acquire(u);
+    double d = r->dist[v];
+    omp_unset_lock(&lock);
+
+    return d;
+}
+
+void distance_oracle::path(ulong u, ulong v, vector<ulong> *p) throw (NoSuchVertexException)
+{
+    if (u < 1 || u > vertex_count)
+        throw NoSuchVertexException(u);
+    if (v < 1 || v > vertex_count)
+        throw NoSuchVertexException(v);
+
+    p->clear();
+
+    const row *r = acquire(u);
+    if (r->dist[v] < DBL_MAX)
+    {
+        for (ulong x = v; x != u; x = r->pred[x])
+            p->push_back(x);
+        p->push_back(u);
+    }
+    omp_unset_lock(&lock);
+
+    reverse(p->begin(), p->end());
+}
+
+void distance_oracle::clear()
+{
+    omp_set_lock(&lock);
+
+    for (list<ulong>::iterator it = recent.begin(); it != recent.end(); ++it)
+    {
+        delete rows[*it];
+        rows[*it] = 0;
+    }
+    recent.clear();
+    cached = 0;
+
+    omp_unset_lock(&lock);
+}
+
+ulong distance_oracle::get_capacity() const { return capacity; }
+
+ulong distance_oracle::get_cached_rows() const
+{
+    omp_set_lock(&lock);
+    ulong count = cached;
+    omp_unset_lock(&lock);
+
+    return count;
+}
+
+ulong distance_oracle::get_hits() const
+{
+    omp_set_lock(&lock);
+    ulong count = hits;
+    omp_unset_lock(&lock);
+
+    return count;
+}
+
+ulong distance_oracle::get_misses() const
+{
+    omp_set_lock(&lock);
+    ulong count = misses;
+    omp_unset_lock(&lock);
+
+    return count;
+}
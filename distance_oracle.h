@@ -0,0 +1,66 @@
+#ifndef __DISTANCE_ORACLE_H__
+#define __DISTANCE_ORACLE_H__
+
+#include <vector>
+#include <list>
+#include <cstddef>
+#include <omp.h>
+#include "types.h"
+
+/**
+ * distance_oracle: all-pairs distances computed on demand. The first query
+ * from a source runs Dijkstra's algorithm from it (so weights must be
+ * nonnegative) and caches its row of distances and predecessors; later
+ * queries from that source read the cached row. Rows are evicted in least
+ * recently used order to stay within the memory budget (at least one row is
+ * kept).
+ *
+ * Queries are thread-safe: lookups hold a lock, while rows missing from the
+ * cache are computed outside it, so misses of distinct threads run in
+ * parallel.
+ */
+class distance_oracle
+{
+public:
+    // constructor (memory budget in bytes for the cached rows) and destructor
+    distance_oracle(AdjacencyList<>*, size_t);
+    virtual ~distance_oracle();
+
+    // d(u,v), DBL_MAX if v is unreachable from u
+    double distance(unsigned long, unsigned long) throw (NoSuchVertexException);
+
+    // path from u to v, both included (empty if v is unreachable)
+    void path(unsigned long, unsigned long, std::vector<unsigned long>*) throw (NoSuchVertexException);
+
+    // drops every cached row (counters are kept)
+    void clear();
+
+    // structure access (get)
+    unsigned long get_capacity() const;   // rows fitting in the budget
+    unsigned long get_cached_rows() const;
+    unsigned long get_hits() const;
+    unsigned long get_misses() const;
+
+private:
+    typedef struct {
+        std::vector<double> dist;
+        std::vector<unsigned int> pred;   // vertex keys fit 32 bits
+    } row;
+
+    const row* acquire(unsigned long);   // returns with the lock held
+    row* compute(unsigned long) const;
+
+    AdjacencyList<> *graph;
+    unsigned long vertex_count;
+    unsigned long capacity;
+
+    std::vector<row*> rows;   // cached row of each source (0 if none)
+    std::list<unsigned long> recent;   // cached sources, most recently used first
+    unsigned long cached;   // size of 'recent' (list::size() may be linear)
+    std::vector<std::list<unsigned long>::iterator> position;
+
+    unsigned long hits, misses;
+    mutable omp_lock_t lock;
+};
+
+#endif /* __DISTANCE_ORACLE_H__ */
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "distance_oracle.h"
+#include "test_util.h"
+
+#define NUM_QUERIES 2000
+#define NUM_SOURCES 40   // queries come from a few sources only
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    unsigned long n = 2000;
+    AdjacencyList<> *graph = randomGraph(n, 4, 100);
+
+    // reference distances of every source queried
+    vector<unsigned long> sources(NUM_SOURCES);
+    vector<vector<double> > expected(NUM_SOURCES, vector<double>(n+1));
+    sssp_workspace ws(n);
+    for (unsigned long i = 0; i<NUM_SOURCES; ++i)
+    {
+        sources[i] = (rand() % n) + 1;
+        dijkstra(graph, sources[i], &ws);
+        for (unsigned long v = 1; v<=n; ++v)
+            expected[i][v] = ws.get_distance(v);
+    }
+
+    // room for 10 rows: queries keep evicting and recomputing rows
+    distance_oracle oracle(graph, 10 * (n+1) * (sizeof(double) + sizeof(unsigned int)));
+
+    vector<unsigned long> query_source(NUM_QUERIES), query_target(NUM_QUERIES);
+    for (unsigned long q = 0; q<NUM_QUERIES; ++q)
+    {
+        query_source[q] = rand() % NUM_SOURCES;
+        query_target[q] = (rand() % n) + 1;
+    }
+
+    unsigned long errors = 0;
+
+    #pragma omp parallel for default(none) shared(oracle, graph, sources, expected, query_source, query_target) reduction(+:errors) schedule(dynamic)
+    for (long q = 0; q<NUM_QUERIES; ++q)
+    {
+        unsigned long s = sources[query_source[q]];
+        unsigned long t = query_target[q];
+        double d = expected[query_source[q]][t];
+
+        if (oracle.distance(s, t) != d)
+            ++errors;
+
+        vector<unsigned long> path;
+        oracle.path(s, t, &path);
+        if (d < DBL_MAX && (path.front() != s || path.back() != t))
+            ++errors;
+        if (d == DBL_MAX && !path.empty())
+            ++errors;
+    }
+
+    unsigned long lookups = oracle.get_hits() + oracle.get_misses();
+    if (lookups != 2 * NUM_QUERIES || oracle.get_cached_rows() > oracle.get_capacity() || oracle.get_capacity() != 10)
+        ++errors;
+
+    cout << oracle.get_hits() << " hits, " << oracle.get_misses() << " misses, "
+        << oracle.get_cached_rows() << " rows cached" << endl;
+    cout << errors << " errors" << endl;
+
+    delete graph;
+    return errors;
+}
@@ -0,0 +1,306 @@
+#include "dynamic_paths.h"
+#include "paths.h"
+#include <omp.h>
+#include <cfloat>   // for DBL_MAX
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+using namespace std;
+
+typedef vector<vector<pair<ulong, Edge*> > > in_arc_lists;
+
+// arcs entering each vertex, pointing to the graph's own edges (current weights)
+static void collect_in_arcs(AdjacencyList<> *graph, in_arc_lists &in_arcs)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    in_arcs.assign(num_vertices+1, vector<pair<ulong, Edge*> >());
+
+    for (ulong u = 1; u<=num_vertices; ++u)
+    {
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            in_arcs[it->get_successor()->get_key()].push_back(make_pair(u, it));
+            it = it->get_next();   // next edge
+        }
+    }
+}
+
+// weight of each changed arc now (its old weight if there is no such arc)
+static void current_weights(AdjacencyList<> *graph, const vector<weight_change> &changes, vector<double> &weights)
+{
+    weights.resize(changes.size());
+    for (ulong i = 0; i<changes.size(); ++i)
+    {
+        Edge *e = graph->isEdge(changes[i].tail, changes[i].head);
+        weights[i] = e ? e->get_weight() : changes[i].old_weight;
+    }
+}
+
+/* repairs the distances 'dist' and predecessors 'pred' (indexed 1..n) from
+ * 'source' after the given changes, whose weights are now 'weights':
+ *  1. heavier tree arcs: the subtrees below them lose their distances;
+ *  2. each of those vertices takes the best arc from an unaffected vertex,
+ *     and lighter arcs improving their heads seed them too;
+ *  3. a dijkstra search from the seeds settles every change.
+ * 'queue' and 'affected' (all clear) and 'invalid' are scratch space, left
+ * clear. Returns the number of vertices invalidated or settled
+ */
+static ulong repair(AdjacencyList<> *graph, const in_arc_lists &in_arcs, ulong source,
+    double *dist, ulong *pred, const vector<weight_change> &changes, const vector<double> &weights,
+    vertex_heap &queue, vector<char> &affected, vector<ulong> &invalid)
+{
+    invalid.clear();
+
+    for (ulong i = 0; i<changes.size(); ++i)
+    {
+        ulong head = changes[i].head;
+        if (weights[i] <= changes[i].old_weight || pred[head] != changes[i].tail
+            || head == source || affected[head])
+            continue;
+
+        // subtree below the arc: children are successors whose predecessor is the parent
+        ulong first = invalid.size();
+        invalid.push_back(head);
+        affected[head] = 1;
+
+        for (ulong k = first; k<invalid.size(); ++k)
+        {
+            ulong v = invalid[k];
+            Edge* it = graph->get_vertex(v)->get_adjacencies();
+            while (it)
+            {
+                ulong x = it->get_successor()->get_key();
+                if (pred[x] == v && !affected[x] && x != source)
+                {
+                    affected[x] = 1;
+                    invalid.push_back(x);
+                }
+                it = it->get_next();   // next edge
+            }
+        }
+    }
+
+    for (ulong k = 0; k<invalid.size(); ++k)
+    {
+        dist[invalid[k]] = DBL_MAX;
+        pred[invalid[k]] = 0;
+    }
+
+    // seeds: best arc into each affected vertex from outside the subtrees
+    for (ulong k = 0; k<invalid.size(); ++k)
+    {
+        ulong v = invalid[k];
+        const vector<pair<ulong, Edge*> > &in = in_arcs[v];
+
+        for (ulong i = 0; i<in.size(); ++i)
+        {
+            ulong u = in[i].first;
+            if (!affected[u] && dist[u] < DBL_MAX && dist[u] + in[i].second->get_weight() < dist[v])
+            {
+                dist[v] = dist[u] + in[i].second->get_weight();
+                pred[v] = u;
+            }
+        }
+
+        if (dist[v] < DBL_MAX)
+            queue.push(v, dist[v]);
+    }
+
+    // seeds: heads improved by lighter arcs
+    for (ulong i = 0; i<changes.size(); ++i)
+    {
+        ulong tail = changes[i].tail, head = changes[i].head;
+        if (weights[i] < changes[i].old_weight && dist[tail] < DBL_MAX
+            && dist[tail] + weights[i] < dist[head])
+        {
+            dist[head] = dist[tail] + weights[i];
+            pred[head] = tail;
+            queue.push(head, dist[head]);
+        }
+    }
+
+    // every label is now an upper bound: dijkstra from the seeds
+    ulong touched = 0;
+    while (!queue.empty())
+    {
+        ulong v = queue.extract_min();
+        ++touched;
+        affected[v] = 0;
+
+        Edge* it = graph->get_vertex(v)->get_adjacencies();
+        while (it)
+        {
+            ulong x = it->get_successor()->get_key();
+            double d = dist[v] + it->get_weight();
+
+            if (d < dist[x])
+            {
+                dist[x] = d;
+                pred[x] = v;
+                queue.push(x, d);
+            }
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    // affected vertices left unreachable
+    for (ulong k = 0; k<invalid.size(); ++k)
+    {
+        if (affected[invalid[k]])
+        {
+            affected[invalid[k]] = 0;
+            ++touched;
+        }
+    }
+
+    return touched;
+}
+
+/*
+ * Dynamic single-source implementation
+ */
+
+dynamic_sssp::dynamic_sssp(AdjacencyList<> *g, ulong s)
+: queue(g->get_vertex_count())
+{
+    graph = g;
+    source = s;
+
+    ulong num_vertices = g->get_vertex_count();
+    collect_in_arcs(g, in_arcs);
+    affected.assign(num_vertices+1, 0);
+
+    sssp_workspace ws(num_vertices);
+    dijkstra(g, s, &ws);
+
+    dist.resize(num_vertices+1);
+    pred.resize(num_vertices+1);
+    for (ulong v = 1; v<=num_vertices; ++v)
+    {
+        dist[v] = ws.get_distance(v);
+        pred[v] = ws.get_predecessor(v);
+    }
+}
+
+dynamic_sssp::~dynamic_sssp() { }
+
+ulong dynamic_sssp::update(const vector<weight_change> &changes)
+{
+    vector<double> weights;
+    current_weights(graph, changes, weights);
+
+    return repair(graph, in_arcs, source, &dist[0], &pred[0], changes, weights, queue, affected, invalid);
+}
+
+double dynamic_sssp::get_distance(ulong v) const throw (NoSuchVertexException)
+{
+    if (v < 1 || v >= dist.size())
+        throw NoSuchVertexException(v);
+
+    return dist[v];
+}
+
+ulong dynamic_sssp::get_predecessor(ulong v) const throw (NoSuchVertexException)
+{
+    if (v < 1 || v >= pred.size())
+        throw NoSuchVertexException(v);
+
+    return pred[v];
+}
+
+void dynamic_sssp::get_path(ulong v, vector<ulong> *path) const throw (NoSuchVertexException)
+{
+    path->clear();
+    if (get_distance(v) == DBL_MAX)
+        return;
+
+    for (ulong x = v; x != source; x = pred[x])
+        path->push_back(x);
+    path->push_back(source);
+
+    reverse(path->begin(), path->end());
+}
+
+/*
+ * Dynamic all-pairs implementation
+ */
+
+template <class D>
+ulong update_all_pairs(AdjacencyList<> *graph, AllPairsResult<D> *result, const vector<weight_change> &changes)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    if (result->get_vertex_count() != num_vertices)
+    {
+        cerr << "[magical] result given to update_all_pairs does not match the graph size." << endl;
+        return 0;
+    }
+
+    // openmp setup: the same settings as johnson's algorithm
+    if ( !magical_config::load_settings("johnson", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+    magical_config::load_schedule("johnson");
+
+    in_arc_lists in_arcs;
+    collect_in_arcs(graph, in_arcs);
+
+    vector<double> weights;
+    current_weights(graph, changes, weights);
+
+    ulong touched = 0;
+
+    #pragma omp parallel default(none) shared(graph, result, changes, in_arcs, weights, num_vertices) reduction(+:touched)
+    {
+        // per-thread scratch and row buffers
+        vertex_heap queue(num_vertices);
+        vector<char> affected(num_vertices+1, 0);
+        vector<ulong> invalid;
+        vector<double> d(num_vertices+1);
+        vector<ulong> p(num_vertices+1);
+
+        #pragma omp for schedule(runtime)
+        for (long u = 1; u <= (signed) num_vertices; ++u)
+        {
+            // rows where no change matters are skipped in O(changes)
+            bool concerned = false;
+            for (ulong i = 0; i<changes.size() && !concerned; ++i)
+            {
+                ulong tail = changes[i].tail, head = changes[i].head;
+
+                if (weights[i] > changes[i].old_weight)
+                    concerned = result->predecessor(u, head) == tail;
+                else if (weights[i] < changes[i].old_weight && result->is_reachable(u, tail))
+                    concerned = !result->is_reachable(u, head)
+                        || (double) result->distance(u, tail) + weights[i] < (double) result->distance(u, head);
+            }
+
+            if (!concerned)
+                continue;
+
+            for (ulong v = 1; v<=num_vertices; ++v)
+            {
+                d[v] = result->is_reachable(u, v) ? (double) result->distance(u, v) : DBL_MAX;
+                p[v] = result->predecessor(u, v);
+            }
+
+            touched += repair(graph, in_arcs, u, &d[0], &p[0], changes, weights, queue, affected, invalid);
+            result->set_row(u, &d[0], &p[0]);
+        }
+    }
+
+    return touched;
+}
+
+// distance types supported by AllPairsResult
+template ulong update_all_pairs<double>(AdjacencyList<>*, AllPairsResult<double>*, const vector<weight_change>&);
+template ulong update_all_pairs<float>(AdjacencyList<>*, AllPairsResult<float>*, const vector<weight_change>&);
+template ulong update_all_pairs<unsigned int>(AdjacencyList<>*, AllPairsResult<unsigned int>*, const vector<weight_change>&);
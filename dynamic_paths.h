@@ -0,0 +1,67 @@
+#ifndef __DYNAMIC_PATHS_H__
+#define __DYNAMIC_PATHS_H__
+
+#include <vector>
+#include <utility>
+#include "types.h"
+#include "heap.h"
+#include "all_pairs.h"
+
+/* arc weight change, given after Edge::set_weight() was applied to the arc
+ * tail->head (the one found by isEdge): its weight before the change
+ */
+typedef struct {
+    unsigned long tail, head;
+    double old_weight;
+} weight_change;
+
+/**
+ * dynamic_sssp: single-source shortest paths kept up to date as arc weights
+ * change (nonnegative weights), in the spirit of Ramalingam & Reps (1996).
+ * After a batch of changes, only the subtrees below heavier tree arcs lose
+ * their distances; they are rebuilt from their unaffected in-neighbors by a
+ * Dijkstra search which also spreads the improvements of lighter arcs, so the
+ * cost depends on the part of the tree that changes rather than on the graph.
+ *
+ * Arcs must not be added or removed while the structure is in use.
+ */
+class dynamic_sssp
+{
+public:
+    // constructor: runs dijkstra from the source
+    dynamic_sssp(AdjacencyList<>*, unsigned long);
+    virtual ~dynamic_sssp();
+
+    /* repairs the distances after a batch of weight changes; returns the
+     * number of vertices whose distance was recomputed
+     */
+    unsigned long update(const std::vector<weight_change>&);
+
+    // structure access (get)
+    double get_distance(unsigned long) const throw (NoSuchVertexException);   // DBL_MAX if unreachable
+    unsigned long get_predecessor(unsigned long) const throw (NoSuchVertexException);   // 0 for the source
+    void get_path(unsigned long, std::vector<unsigned long>*) const throw (NoSuchVertexException);
+
+private:
+    AdjacencyList<> *graph;
+    unsigned long source;
+
+    std::vector<std::vector<std::pair<unsigned long, Edge*> > > in_arcs;   // (tail, arc) entering each vertex
+    std::vector<double> dist;
+    std::vector<unsigned long> pred;
+
+    // repair scratch
+    vertex_heap queue;
+    std::vector<char> affected;
+    std::vector<unsigned long> invalid;
+};
+
+/* all-pairs counterpart, on the results of johnson() (or floyd_warshall()):
+ * rows concerned by some change are repaired in parallel, with the settings
+ * of johnson in magical_config. Returns the number of (row, vertex) entries
+ * recomputed
+ */
+template <class D>
+unsigned long update_all_pairs(AdjacencyList<>*, AllPairsResult<D>*, const std::vector<weight_change>&);
+
+#endif /* __DYNAMIC_PATHS_H__ */
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include "types.h"
+#include "paths.h"
+#include "dynamic_paths.h"
+#include "test_util.h"
+
+#define NUM_BATCHES 50
+#define BATCH_SIZE 5
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// changes the weight of a few random arcs (heavier or lighter), recording them
+void random_changes(AdjacencyList<> *g, vector<weight_change> *changes)
+{
+    changes->clear();
+    for (int i = 0; i<BATCH_SIZE; ++i)
+    {
+        unsigned long u = (rand() % g->get_vertex_count()) + 1;
+        Edge *e = g->get_vertex(u)->get_adjacencies();
+        if (!e)
+            continue;
+
+        // the change applies to the arc isEdge() finds
+        e = g->isEdge(u, e->get_successor()->get_key());
+
+        weight_change c = { u, e->get_successor()->get_key(), e->get_weight() };
+        e->set_weight(rand() % 2 ? e->get_weight() * 3 + 10 : e->get_weight() / 4);
+        changes->push_back(c);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+
+    // single source: against a fresh dijkstra after every batch
+    unsigned long n = 3000;
+    AdjacencyList<> *graph = randomGraph(n, 4, 100);
+    dynamic_sssp sssp(graph, 1);
+    sssp_workspace ws(n);
+    vector<weight_change> changes;
+    unsigned long touched = 0;
+
+    for (int b = 0; b<NUM_BATCHES; ++b)
+    {
+        random_changes(graph, &changes);
+        touched += sssp.update(changes);
+
+        dijkstra(graph, 1, &ws);
+        for (unsigned long v = 1; v<=n; ++v)
+        {
+            errors += check(sssp.get_distance(v) == ws.get_distance(v), "dynamic distance");
+
+            unsigned long p = sssp.get_predecessor(v);
+            if (p != 0)
+            {
+                Edge *e = graph->get_vertex(p)->get_adjacencies();
+                bool tight = false;
+                for (; e; e = e->get_next())
+                    tight = tight || (e->get_successor()->get_key() == v
+                        && sssp.get_distance(p) + e->get_weight() == sssp.get_distance(v));
+                errors += check(tight, "dynamic predecessor");
+            }
+        }
+    }
+    cout << "single source: " << (double) touched / NUM_BATCHES << " vertices touched per batch of "
+        << BATCH_SIZE << " (of " << n << ")" << endl;
+    delete graph;
+
+    // all pairs: against johnson after every batch
+    n = 300;
+    graph = randomGraph(n, 4, 100);
+    AllPairsResult<> result(n), expected(n);
+    johnson(graph, &result);
+    touched = 0;
+
+    for (int b = 0; b<NUM_BATCHES; ++b)
+    {
+        random_changes(graph, &changes);
+        touched += update_all_pairs(graph, &result, changes);
+
+        johnson(graph, &expected);
+        for (unsigned long u = 1; u<=n; ++u)
+            for (unsigned long v = 1; v<=n; ++v)
+                errors += check(result.distance(u, v) == expected.distance(u, v), "dynamic all-pairs distance");
+    }
+    cout << "all pairs: " << (double) touched / NUM_BATCHES << " entries touched per batch of "
+        << BATCH_SIZE << " (of " << n*n << ")" << endl;
+    delete graph;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
@@ -1,7 +1,7 @@
 #include "euler_tour.h"
 //#include <omp.h>
 
-#define DEBUG
+//#define DEBUG
 //#define DEBUG1
 #define PROCS 1
 #define OPENMP
@@ -11,7 +11,6 @@ void build_circuit(vector<ulong>*,vector<ulong>*);
 bool euler_tour(AdjacencyList<>* g, std::vector<ulong>* circuit, ulong nEdges)
 {
     AdjacencyList<>* gs;
-    ulong numNodes = g->get_vertex_count();
     map<string, pair<ulong,Edge*> > tours[PROCS];
     vector<ulong> circuit_aux;
     vector<ulong> build;
@@ -56,7 +55,10 @@ bool euler_tour(AdjacencyList<>* g, std::vector<ulong>* circuit, ulong nEdges)
  
     //for(int i=0; i<nEdges; i++)
         //circuit_aux.push_back(0);
-    circuit_aux.reserve(numNodes+nEdges);
+    /* one position per edge, one per tour start (at most one per edge) and
+     * the closing vertex; written by index, so sized rather than reserved
+     */
+    circuit_aux.resize(2*nEdges+2);
     stop = false;
     k = 0;
     while(!stop)
@@ -168,8 +170,7 @@ bool euler_tour(AdjacencyList<>* g, std::vector<ulong>* circuit, ulong nEdges)
                 }
         }
     }
-    circuit_aux.push_back(circuit_aux[0]);
-    k++;
+    circuit_aux[k++] = circuit_aux[0];
 
 #ifdef DEBUG
     cout<<"circuit_aux:";
@@ -239,15 +240,15 @@ bool euler_tour(AdjacencyList<>* g, std::vector<ulong>* circuit, ulong nEdges)
             }
             else
             {
-                if(circuit->size() == nEdges)
-                    stop = true;
-                else
+                /*the first tour opens and closes the circuit*/
+                circuit->push_back(startV);
+                if(is == 0)
                     is++;
+                else
+                    stop = true;
             }
         }
     }
-    if(circuit->back() != circuit->front())
-        circuit->push_back(circuit_aux[0]);
     
     circuit_aux.clear();
     build.clear();
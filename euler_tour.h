@@ -15,7 +15,9 @@
 
 using namespace std;
 
-/* Hierholzer's algorithm for finding an Euleur's circuit */
+/* Hierholzer's algorithm for finding an Euleur's circuit, given the number of
+ * edges: the vertices of the circuit, starting and ending at the same one
+ */
 bool euler_tour(AdjacencyList<>*, std::vector<unsigned long>*, ulong);
 
 #endif /* __EULER_H__ */
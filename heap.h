@@ -0,0 +1,219 @@
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include <vector>
+#include <utility>
+#include <climits>   // for CHAR_BIT
+
+/**
+ * vertex_heap: min-heap based priority queue indexed by vertex key (1..n).
+ * Unlike the heap used by dijkstra(), only vertices actually reached are ever
+ * inserted, so searches which stop early (or prune the graph, as goal-directed
+ * searches do) pay only for the part of the graph they touch.
+ */
+class vertex_heap
+{
+public:
+    vertex_heap(unsigned long num_vertices)
+    : position(num_vertices+1, 0)
+    {
+        heap.push_back(std::make_pair(0.0, 0UL));   // dummy head
+    }
+
+    bool empty() const
+    {
+        return heap.size() == 1;
+    }
+
+    unsigned long get_size() const
+    {
+        return heap.size() - 1;
+    }
+
+    bool contains(unsigned long v) const
+    {
+        return position[v] != 0;
+    }
+
+    double min_key() const
+    {
+        return heap[1].first;
+    }
+
+    unsigned long min() const
+    {
+        return heap[1].second;
+    }
+
+    /* inserts 'v', or decreases its key if it is already in the heap (a
+     * greater key is ignored)
+     */
+    void push(unsigned long v, double key)
+    {
+        unsigned long i = position[v];
+
+        if (i == 0)
+        {
+            heap.push_back(std::make_pair(key, v));
+            i = heap.size() - 1;
+            position[v] = i;
+        }
+        else if (key < heap[i].first)
+            heap[i].first = key;
+        else
+            return;
+
+        sift_up(i);
+    }
+
+    unsigned long extract_min()
+    {
+        unsigned long v = heap[1].second;
+        position[v] = 0;
+
+        // move last leaf to the root and restore heap property
+        if (heap.size() > 2)
+        {
+            heap[1] = heap.back();
+            position[heap[1].second] = 1;
+            heap.pop_back();
+            sift_down(1);
+        }
+        else
+            heap.pop_back();
+
+        return v;
+    }
+
+    /* empties the heap, resetting only the handles of remaining elements */
+    void clear()
+    {
+        for (unsigned long i = 1; i<heap.size(); ++i)
+            position[heap[i].second] = 0;
+
+        heap.resize(1);
+    }
+
+private:
+    void sift_up(unsigned long i)
+    {
+        std::pair<double, unsigned long> e = heap[i];
+
+        // move parents down until a smaller one is found
+        while (i > 1 && heap[i/2].first > e.first)
+        {
+            heap[i] = heap[i/2];
+            position[heap[i].second] = i;
+            i /= 2;
+        }
+
+        heap[i] = e;
+        position[e.second] = i;
+    }
+
+    void sift_down(unsigned long i)
+    {
+        unsigned long size = heap.size() - 1;
+        std::pair<double, unsigned long> e = heap[i];
+
+        // move smallest child up until heap property holds
+        while (2*i <= size)
+        {
+            unsigned long child = 2*i;
+            if (child < size && heap[child+1].first < heap[child].first)
+                ++child;
+
+            if (heap[child].first >= e.first)
+                break;
+
+            heap[i] = heap[child];
+            position[heap[i].second] = i;
+            i = child;
+        }
+
+        heap[i] = e;
+        position[e.second] = i;
+    }
+
+    std::vector< std::pair<double, unsigned long> > heap;   // (key, vertex)
+    std::vector<unsigned long> position;   // handle: vertex -> heap node (0 if absent)
+};
+
+/**
+ * radix_heap: monotone priority queue for integer keys (Ahuja et al. 1990).
+ * Bucket i > 0 holds the entries whose key first differs from the last one
+ * extracted at bit i-1, so an entry moves down at most once per bit before
+ * it is extracted. Keys pushed must not be smaller than the last extracted
+ * one. Vertices may be pushed again with smaller keys: the stale entries are
+ * extracted too, and left for the caller to skip.
+ */
+class radix_heap
+{
+public:
+    radix_heap()
+    : buckets(sizeof(unsigned long) * CHAR_BIT + 1)
+    {
+        last = 0;
+        size = 0;
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    void push(unsigned long v, unsigned long key)
+    {
+        buckets[bucket(key)].push_back(std::make_pair(key, v));
+        ++size;
+    }
+
+    /* smallest entry: (key, vertex) */
+    std::pair<unsigned long, unsigned long> extract_min()
+    {
+        if (buckets[0].empty())
+        {
+            // first nonempty bucket: its smallest key is the new last one
+            unsigned long i = 1;
+            while (buckets[i].empty())
+                ++i;
+
+            std::vector< std::pair<unsigned long, unsigned long> > &b = buckets[i];
+            last = b[0].first;
+            for (unsigned long k = 1; k<b.size(); ++k)
+                if (b[k].first < last)
+                    last = b[k].first;
+
+            // every entry moves to a lower bucket
+            for (unsigned long k = 0; k<b.size(); ++k)
+                buckets[bucket(b[k].first)].push_back(b[k]);
+            b.clear();
+        }
+
+        std::pair<unsigned long, unsigned long> e = buckets[0].back();
+        buckets[0].pop_back();
+        --size;
+        return e;
+    }
+
+    void clear()
+    {
+        for (unsigned long i = 0; i<buckets.size(); ++i)
+            buckets[i].clear();
+
+        last = 0;
+        size = 0;
+    }
+
+private:
+    // 0 for the last key, else 1 + the highest bit where the key differs from it
+    unsigned long bucket(unsigned long key) const
+    {
+        return (key == last) ? 0 : sizeof(unsigned long) * CHAR_BIT - __builtin_clzl(key ^ last);
+    }
+
+    std::vector< std::vector< std::pair<unsigned long, unsigned long> > > buckets;   // (key, vertex)
+    unsigned long last, size;
+};
+
+#endif /* __HEAP_H__ */
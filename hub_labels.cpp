@@ -0,0 +1,321 @@
+#include "hub_labels.h"
+#include "sssp_workspace.h"
+#include "contraction.h"
+#include <omp.h>
+#include <cfloat>    // for DBL_MAX
+#include <climits>   // for UINT_MAX
+#include <cstdio>    // for fopen, fwrite, fread
+#include <cstring>   // for memcmp
+#include <algorithm>
+#include <utility>
+#include <iostream>
+#include "magical_config.h"
+#include "binary_io.h"
+
+#define ulong unsigned long
+
+#define HL_FILE_MAGIC "MAGICHL1"
+#define HL_SENTINEL UINT_MAX   // hub rank closing every label
+
+using namespace std;
+
+// label during the build: (hub rank, distance) pairs
+typedef vector<pair<unsigned int, double> > label;
+
+// label entry found by a batch of hubs, committed at its end
+typedef struct {
+    ulong vertex;
+    unsigned int hub;
+    double dist;
+} label_entry;
+
+/* pruned dijkstra from the hub 'h' of rank 'r': a settled vertex v is pruned
+ * if some committed hub x gives d(h,x) + d(x,v) <= d(h,v), taking d(h,x) from
+ * the hub's 'own' label (spread by rank in 'hub_dist') and d(x,v) from the
+ * 'other' label of v; otherwise (r, d(h,v)) joins the other label of v. On the
+ * transpose, the same search fills out-labels from in-labels
+ */
+static void pruned_search(AdjacencyList<> *graph, ulong h, unsigned int r,
+    const vector<label> &own, const vector<label> &other,
+    vector<double> &hub_dist, sssp_workspace &ws, vector<label_entry> &found)
+{
+    const label &lh = own[h];
+    for (ulong i = 0; i<lh.size(); ++i)
+        hub_dist[lh[i].first] = lh[i].second;
+
+    ws.reset();
+    ws.add_source(h);
+
+    while (ws.has_next())
+    {
+        ulong v = ws.settle_next();
+        double d = ws.get_distance(v);
+
+        const label &lv = other[v];
+        bool covered = false;
+        for (ulong i = 0; i<lv.size() && !covered; ++i)
+        {
+            double dx = hub_dist[lv[i].first];
+            covered = dx < DBL_MAX && dx + lv[i].second <= d;
+        }
+
+        if (covered)
+            continue;   // neither labeled nor expanded
+
+        label_entry e = { v, r, d };
+        found.push_back(e);
+
+        Edge* it = graph->get_vertex(v)->get_adjacencies();
+        while (it)
+        {
+            ws.relax(it->get_successor()->get_key(), d + it->get_weight(), v);
+            it = it->get_next();   // next edge
+        }
+    }
+
+    for (ulong i = 0; i<lh.size(); ++i)
+        hub_dist[lh[i].first] = DBL_MAX;
+}
+
+/* contiguous layout: each label sorted by hub rank, closed by the sentinel */
+static void flatten(vector<label> &labels, vector<ulong> &first, vector<unsigned int> &hub, vector<double> &dist)
+{
+    long num_vertices = labels.size() - 1;
+
+    first.assign(num_vertices+2, 0);
+    for (long v = 1; v <= num_vertices; ++v)
+        first[v+1] = first[v] + labels[v].size() + 1;
+
+    hub.resize(first[num_vertices+1]);
+    dist.resize(first[num_vertices+1]);
+
+    #pragma omp parallel for default(none) shared(labels, first, hub, dist, num_vertices) schedule(dynamic, 256)
+    for (long v = 1; v <= num_vertices; ++v)
+    {
+        sort(labels[v].begin(), labels[v].end());
+
+        ulong pos = first[v];
+        for (ulong i = 0; i<labels[v].size(); ++i, ++pos)
+        {
+            hub[pos] = labels[v][i].first;
+            dist[pos] = labels[v][i].second;
+        }
+
+        hub[pos] = HL_SENTINEL;
+        dist[pos] = DBL_MAX;
+
+        label().swap(labels[v]);   // release as we go
+    }
+}
+
+/*
+ * Hub labeling implementation
+ */
+
+hub_labeling::hub_labeling()
+{
+    vertex_count = 0;
+}
+
+hub_labeling::~hub_labeling()
+{
+    clear();
+}
+
+void hub_labeling::clear()
+{
+    vertex_count = 0;
+    out_first.clear(); out_hub.clear(); out_dist.clear();
+    in_first.clear(); in_hub.clear(); in_dist.clear();
+}
+
+bool hub_labeling::build(AdjacencyList<> *graph)
+{
+    clear();
+
+    ulong num_vertices = graph->get_vertex_count();
+
+    /* hub order: most important vertices of a contraction hierarchy first,
+     * as they lie on the most shortest paths (which also checks weights)
+     */
+    contraction_hierarchy ch;
+    if (!ch.build(graph))
+    {
+        cerr << "[magical] graph given to hub labeling has negative weights." << endl;
+        return false;
+    }
+
+    vector<ulong> order(num_vertices);
+    for (ulong v = 1; v<=num_vertices; ++v)
+        order[num_vertices - ch.get_rank(v)] = v;
+
+    // openmp setup
+    if ( !magical_config::load_settings("hub_labels", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    AdjacencyList<> *reverse = transpose(graph);
+    vector<label> in_labels(num_vertices+1), out_labels(num_vertices+1);
+
+    int num_threads = omp_get_max_threads();
+    vector<vector<label_entry> > found_in(num_threads), found_out(num_threads);
+
+    #pragma omp parallel default(none) shared(graph, reverse, order, in_labels, out_labels, found_in, found_out, num_vertices, num_threads)
+    {
+        sssp_workspace ws(num_vertices);
+        vector<double> hub_dist(num_vertices, DBL_MAX);   // indexed by rank
+        int thr = omp_get_thread_num();
+
+        // every thread walks the same batches
+        ulong next = 0;
+        while (next < num_vertices)
+        {
+            /* the first hubs prune the most, so they run alone; batches then
+             * grow up to a few hubs per thread
+             */
+            ulong batch = (num_threads == 1) ? 1 : min((ulong) 4*num_threads, next/16 + 1);
+            ulong end = min(num_vertices, next + batch);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (long r = next; r < (signed) end; ++r)
+            {
+                pruned_search(graph, order[r], r, out_labels, in_labels, hub_dist, ws, found_in[thr]);
+                pruned_search(reverse, order[r], r, in_labels, out_labels, hub_dist, ws, found_out[thr]);
+            }
+
+            // commit the batch: the next one prunes against it
+            #pragma omp single
+            for (int t = 0; t<num_threads; ++t)
+            {
+                for (ulong i = 0; i<found_in[t].size(); ++i)
+                    in_labels[found_in[t][i].vertex].push_back(make_pair(found_in[t][i].hub, found_in[t][i].dist));
+                for (ulong i = 0; i<found_out[t].size(); ++i)
+                    out_labels[found_out[t][i].vertex].push_back(make_pair(found_out[t][i].hub, found_out[t][i].dist));
+
+                found_in[t].clear();
+                found_out[t].clear();
+            }
+
+            next = end;
+        }
+    }
+
+    delete reverse;
+
+    flatten(out_labels, out_first, out_hub, out_dist);
+    flatten(in_labels, in_first, in_hub, in_dist);
+    vertex_count = num_vertices;
+
+    return true;
+}
+
+double hub_labeling::distance(ulong s, ulong t) const throw (NoSuchVertexException)
+{
+    if (s < 1 || s > vertex_count)
+        throw NoSuchVertexException(s);
+    if (t < 1 || t > vertex_count)
+        throw NoSuchVertexException(t);
+
+    // merge of both sorted labels; the sentinels end it without bound checks
+    ulong i = out_first[s], j = in_first[t];
+    double best = DBL_MAX;
+
+    for (;;)
+    {
+        unsigned int a = out_hub[i], b = in_hub[j];
+
+        if (a == b)
+        {
+            if (a == HL_SENTINEL)
+                break;
+
+            best = min(best, out_dist[i] + in_dist[j]);
+            ++i;
+            ++j;
+        }
+        else if (a < b)
+            ++i;
+        else
+            ++j;
+    }
+
+    return best;
+}
+
+/*
+ * Persistence: a magic string followed by the vertex count and every array, as
+ * written by fwrite (hence files are not portable across architectures)
+ */
+
+bool hub_labeling::save(const char *filename) const
+{
+    FILE *fh = fopen(filename, "wb");
+    if (!fh)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        return false;
+    }
+
+    bool ok = fwrite(HL_FILE_MAGIC, 1, 8, fh) == 8
+        && fwrite(&vertex_count, sizeof(ulong), 1, fh) == 1
+        && write_vector(fh, out_first) && write_vector(fh, out_hub) && write_vector(fh, out_dist)
+        && write_vector(fh, in_first) && write_vector(fh, in_hub) && write_vector(fh, in_dist);
+
+    ok = (fclose(fh) == 0) && ok;
+    if (!ok)
+        cerr << "[magical] could not write hub labels to " << filename << endl;
+
+    return ok;
+}
+
+bool hub_labeling::load(const char *filename)
+{
+    clear();
+
+    FILE *fh = fopen(filename, "rb");
+    if (!fh)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        return false;
+    }
+
+    char magic[8];
+    bool ok = fread(magic, 1, 8, fh) == 8 && memcmp(magic, HL_FILE_MAGIC, 8) == 0
+        && fread(&vertex_count, sizeof(ulong), 1, fh) == 1
+        && read_vector(fh, out_first) && read_vector(fh, out_hub) && read_vector(fh, out_dist)
+        && read_vector(fh, in_first) && read_vector(fh, in_hub) && read_vector(fh, in_dist);
+    fclose(fh);
+
+    // consistency of the layout (sentinels included)
+    ok = ok && out_first.size() == vertex_count+2 && in_first.size() == vertex_count+2
+        && out_first[vertex_count+1] == out_hub.size() && out_hub.size() == out_dist.size()
+        && in_first[vertex_count+1] == in_hub.size() && in_hub.size() == in_dist.size()
+        && out_first[1] == 0 && in_first[1] == 0;
+
+    for (ulong v = 1; ok && v<=vertex_count; ++v)
+    {
+        ok = out_first[v+1] > out_first[v] && in_first[v+1] > in_first[v]
+            && out_hub[out_first[v+1]-1] == HL_SENTINEL && in_hub[in_first[v+1]-1] == HL_SENTINEL;
+    }
+
+    if (!ok)
+    {
+        cerr << "[magical] invalid hub labels file " << filename << endl;
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+ulong hub_labeling::get_vertex_count() const { return vertex_count; }
+
+ulong hub_labeling::get_label_count() const
+{
+    // every label ends with a sentinel
+    return (vertex_count == 0) ? 0 : out_hub.size() + in_hub.size() - 2*vertex_count;
+}
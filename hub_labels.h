@@ -0,0 +1,57 @@
+#ifndef __HUB_LABELS_H__
+#define __HUB_LABELS_H__
+
+#include <vector>
+#include "types.h"
+
+/**
+ * hub_labeling: exact distance index by pruned landmark labeling (Akiba et
+ * al. 2013) for graphs with nonnegative weights. Each vertex v keeps an
+ * out-label of hubs h with d(v,h) and an in-label of hubs h with d(h,v), such
+ * that every shortest s->t path meets a hub in both labels of s and t; then
+ *     d(s,t) = min over common hubs h of d(s,h) + d(h,t),
+ * a merge of two short sorted arrays.
+ *
+ * Hubs are taken in decreasing order of contraction hierarchy rank (vertices
+ * on many shortest paths first), each running a pruned Dijkstra search
+ * (forward for in-labels, on the transpose for out-labels) that stops at
+ * vertices the labels of earlier hubs already cover. Batches of hubs run in
+ * parallel against the labels of previous batches, which may add redundant
+ * entries but never wrong ones. Labels are stored contiguously, sorted by hub
+ * rank and closed by a sentinel.
+ */
+class hub_labeling
+{
+public:
+    // constructor and destructor
+    hub_labeling();
+    virtual ~hub_labeling();
+
+    // builds the labels; returns false if the graph has negative weights
+    bool build(AdjacencyList<>*);
+
+    // d(s,t), DBL_MAX if t is unreachable from s
+    double distance(unsigned long, unsigned long) const throw (NoSuchVertexException);
+
+    // persistence: return false on I/O errors (or invalid file, when loading)
+    bool save(const char*) const;
+    bool load(const char*);
+
+    // structure access (get)
+    unsigned long get_vertex_count() const;
+    unsigned long get_label_count() const;   // entries of every label
+
+private:
+    void clear();
+
+    unsigned long vertex_count;
+
+    /* labels of vertex v: positions [first[v], first[v+1]) of the hub (rank)
+     * and distance arrays, the last one being the sentinel
+     */
+    std::vector<unsigned long> out_first, in_first;
+    std::vector<unsigned int> out_hub, in_hub;
+    std::vector<double> out_dist, in_dist;
+};
+
+#endif /* __HUB_LABELS_H__ */
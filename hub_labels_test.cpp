@@ -0,0 +1,118 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cfloat>
+#include "types.h"
+#include "paths.h"
+#include "hub_labels.h"
+
+#include <sys/time.h>       // for 'gettimeofday()'
+
+#define NUM_QUERIES 2000
+
+using namespace std;
+
+// -- time evaluation functions ------------------------------------------------
+
+double wall_time()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1.e-6 * t.tv_usec;
+}
+
+// -----------------------------------------------------------------------------
+
+// road-like instance: side x side grid, with one-way streets now and then
+AdjacencyList<>* gridGraph(unsigned long side, unsigned long range)
+{
+    AdjacencyList<> *grid = new AdjacencyList<>(side*side);
+
+    srand(1234567);
+
+    for (unsigned long r = 0; r<side; ++r)
+    {
+        for (unsigned long c = 0; c<side; ++c)
+        {
+            unsigned long v = r*side + c + 1;
+            if (c+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v, v+1, w);
+                if (rand() % 10)
+                    grid->addEdge(v+1, v, w);
+            }
+            if (r+1 < side)
+            {
+                unsigned long w = (rand() % range) + 1;
+                grid->addEdge(v+side, v, w);
+                if (rand() % 10)
+                    grid->addEdge(v, v+side, w);
+            }
+        }
+    }
+
+    return grid;
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    unsigned long side = (argc > 1) ? atol(argv[1]) : 60;
+    AdjacencyList<> *graph = gridGraph(side, 100);
+    unsigned long num_vertices = graph->get_vertex_count();
+
+    hub_labeling labels;
+    double start = wall_time();
+    if (!labels.build(graph))
+    {
+        cerr << "build returned false" << endl;
+        return 1;
+    }
+    printf("preprocessing: %.6f (%.1f hubs per vertex)\n", wall_time() - start,
+        (double) labels.get_label_count() / num_vertices);
+
+    // persistence round trip: queries below run on the loaded labels
+    hub_labeling loaded;
+    if (!labels.save("/tmp/magical_hl.bin") || !loaded.load("/tmp/magical_hl.bin"))
+    {
+        cerr << "save/load failed" << endl;
+        return 1;
+    }
+
+    sssp_workspace ws(num_vertices);
+    double dijkstra_time = 0, hl_time = 0;
+    int mismatches = 0;
+
+    srand(7654321);
+    for (int q = 0; q < NUM_QUERIES; ++q)
+    {
+        unsigned long s = (rand() % num_vertices) + 1;
+        unsigned long t = (rand() % num_vertices) + 1;
+
+        vector<unsigned long> targets(1, t);
+        start = wall_time();
+        dijkstra_to_targets(graph, s, targets, &ws);
+        dijkstra_time += wall_time() - start;
+
+        start = wall_time();
+        double d = loaded.distance(s, t);
+        hl_time += wall_time() - start;
+
+        if (d != ws.get_distance(t))
+        {
+            cout << "mismatch " << s << " -> " << t << ": labels " << d
+                << " dijkstra " << ws.get_distance(t) << endl;
+            ++mismatches;
+        }
+    }
+
+    printf("dijkstra: %.6f\nlabels:   %.6f\n", dijkstra_time, hl_time);
+    cout << mismatches << " mismatches in " << NUM_QUERIES << " queries" << endl;
+
+    delete graph;
+
+    return mismatches;
+}
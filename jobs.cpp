@@ -0,0 +1,242 @@
+#include "jobs.h"
+#include "analysis.h"
+#include "paths.h"
+#include "mst.h"
+#include "euler_tour.h"
+#include <omp.h>
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+using namespace std;
+
+/*
+ * Job implementation
+ */
+
+job::job()
+{
+    budget = 1;
+    done = result = false;
+    pthread_mutex_init(&lock, 0);
+    pthread_cond_init(&finished, 0);
+}
+
+job::~job()
+{
+    pthread_cond_destroy(&finished);
+    pthread_mutex_destroy(&lock);
+}
+
+void job::wait()
+{
+    pthread_mutex_lock(&lock);
+    while (!done)
+        pthread_cond_wait(&finished, &lock);
+    pthread_mutex_unlock(&lock);
+}
+
+bool job::is_done()
+{
+    pthread_mutex_lock(&lock);
+    bool d = done;
+    pthread_mutex_unlock(&lock);
+
+    return d;
+}
+
+bool job::succeeded()
+{
+    wait();
+    return result;
+}
+
+void job::finish(bool r)
+{
+    pthread_mutex_lock(&lock);
+    result = r;
+    done = true;
+    pthread_cond_broadcast(&finished);
+    pthread_mutex_unlock(&lock);
+}
+
+dijkstra_job::dijkstra_job(AdjacencyList<> *g, ulong s) throw (NoSuchVertexException)
+: workspace(g->get_vertex_count())
+{
+    g->get_vertex(s);   // throws NoSuchVertexException
+    graph = g;
+    source = s;
+}
+
+const sssp_workspace& dijkstra_job::get_result()
+{
+    wait();
+    return workspace;
+}
+
+bool dijkstra_job::run()
+{
+    return shortest_paths(graph, source, &workspace) != SSSP_NEGATIVE_CYCLE;
+}
+
+johnson_job::johnson_job(AdjacencyList<> *g)
+: result(g->get_vertex_count())
+{
+    graph = g;
+}
+
+const AllPairsResult<>& johnson_job::get_result()
+{
+    wait();
+    return result;
+}
+
+bool johnson_job::run()
+{
+    return johnson(graph, &result);
+}
+
+boruvka_job::boruvka_job(AdjacencyList<> *g)
+{
+    graph = g;
+    mst = new AdjacencyList<>(g->get_vertex_count());
+}
+
+boruvka_job::~boruvka_job()
+{
+    delete mst;
+}
+
+AdjacencyList<>* boruvka_job::get_result()
+{
+    wait();
+    return mst;
+}
+
+bool boruvka_job::run()
+{
+    return boruvka(graph, mst);
+}
+
+euler_tour_job::euler_tour_job(AdjacencyList<> *g, ulong num_edges)
+{
+    graph = g;
+    edge_count = num_edges;
+}
+
+const vector<ulong>& euler_tour_job::get_result()
+{
+    wait();
+    return circuit;
+}
+
+bool euler_tour_job::run()
+{
+    return euler_tour(graph, &circuit, edge_count);
+}
+
+/*
+ * Executor implementation
+ */
+
+job_executor::job_executor(unsigned int num_threads)
+{
+    /* openmp setup, which also reads the configuration before any job asks
+     * for it
+     */
+    if ( !magical_config::load_settings("jobs", 0) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    if (num_threads == 0)
+        num_threads = omp_get_max_threads();
+
+    thread_count = free_threads = num_threads;
+    stopping = false;
+
+    pthread_mutex_init(&lock, 0);
+    pthread_cond_init(&changed, 0);
+
+    // as many workers as jobs may run at once (one thread each)
+    workers.resize(thread_count);
+    for (unsigned int i = 0; i<thread_count; ++i)
+        pthread_create(&workers[i], 0, worker_loop, this);
+}
+
+job_executor::~job_executor()
+{
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+
+    for (ulong i = 0; i<workers.size(); ++i)
+        pthread_join(workers[i], 0);
+
+    pthread_cond_destroy(&changed);
+    pthread_mutex_destroy(&lock);
+}
+
+unsigned int job_executor::get_thread_count() const
+{
+    return thread_count;
+}
+
+void job_executor::enqueue(job *j, unsigned int budget)
+{
+    j->budget = (budget == 0 || budget > thread_count) ? thread_count : budget;
+
+    pthread_mutex_lock(&lock);
+    queue.push_back(j);
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&lock);
+}
+
+void* job_executor::worker_loop(void *arg)
+{
+    job_executor *executor = (job_executor*) arg;
+
+    pthread_mutex_lock(&executor->lock);
+    for (;;)
+    {
+        // the oldest job, once its threads are free
+        while (!(!executor->queue.empty() && executor->queue.front()->budget <= executor->free_threads)
+            && !(executor->stopping && executor->queue.empty()))
+            pthread_cond_wait(&executor->changed, &executor->lock);
+
+        if (executor->queue.empty())
+            break;   // stopping
+
+        job *j = executor->queue.front();
+        executor->queue.pop_front();
+
+        unsigned int budget = j->budget;
+        executor->free_threads -= budget;
+        pthread_cond_broadcast(&executor->changed);   // the next one may fit too
+        pthread_mutex_unlock(&executor->lock);
+
+        // algorithms set their threads through load_settings(), within the budget
+        magical_config::set_thread_limit(budget);
+        omp_set_num_threads(budget);
+
+        bool result = false;
+        try {
+            result = j->run();
+        } catch (NoSuchVertexException&) {
+            result = false;
+        }
+
+        pthread_mutex_lock(&executor->lock);
+        executor->free_threads += budget;
+        pthread_cond_broadcast(&executor->changed);
+
+        j->finish(result);   // the owner may delete it from here on
+    }
+    pthread_mutex_unlock(&executor->lock);
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#ifndef __JOBS_H__
+#define __JOBS_H__
+
+#include <vector>
+#include <deque>
+#include <pthread.h>
+#include "types.h"
+#include "all_pairs.h"
+#include "sssp_workspace.h"
+
+/**
+ * job: a run of a library algorithm submitted to a job_executor, and its
+ * future: wait() blocks until the run ends, after which the subclass gives
+ * the result. The caller owns the job, and must not delete it before it is
+ * done.
+ */
+class job
+{
+public:
+    job();
+    virtual ~job();
+
+    // blocks until the job has run
+    void wait();
+    bool is_done();
+
+    // what the algorithm returned (waits for it)
+    bool succeeded();
+
+protected:
+    // runs the algorithm, with at most the threads given by the executor
+    virtual bool run() = 0;
+
+private:
+    friend class job_executor;
+
+    void finish(bool);
+
+    unsigned int budget;
+    bool done, result;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+};
+
+/* single-source shortest paths, by shortest_paths() in analysis.h (fails on
+ * negative cycles). Throws for sources not in the graph on construction
+ */
+class dijkstra_job : public job
+{
+public:
+    dijkstra_job(AdjacencyList<>*, unsigned long) throw (NoSuchVertexException);
+
+    const sssp_workspace& get_result();
+
+protected:
+    bool run();
+
+private:
+    AdjacencyList<>* graph;
+    unsigned long source;
+    sssp_workspace workspace;
+};
+
+/* all-pairs shortest paths by johnson() in paths.h */
+class johnson_job : public job
+{
+public:
+    johnson_job(AdjacencyList<>*);
+
+    const AllPairsResult<>& get_result();
+
+protected:
+    bool run();
+
+private:
+    AdjacencyList<>* graph;
+    AllPairsResult<> result;
+};
+
+/* minimum spanning tree by boruvka() in mst.h, owned by the job */
+class boruvka_job : public job
+{
+public:
+    boruvka_job(AdjacencyList<>*);
+    virtual ~boruvka_job();
+
+    AdjacencyList<>* get_result();
+
+protected:
+    bool run();
+
+private:
+    AdjacencyList<>* graph;
+    AdjacencyList<>* mst;
+};
+
+/* euler circuit by euler_tour() in euler_tour.h, given the number of edges.
+ * As that function, the job removes the edges of the graph
+ */
+class euler_tour_job : public job
+{
+public:
+    euler_tour_job(AdjacencyList<>*, unsigned long);
+
+    const std::vector<unsigned long>& get_result();
+
+protected:
+    bool run();
+
+private:
+    AdjacencyList<>* graph;
+    unsigned long edge_count;
+    std::vector<unsigned long> circuit;
+};
+
+/**
+ * job_executor: runs submitted jobs on a shared set of threads, so that many
+ * medium-size runs overlap instead of each taking every core in turn. Each
+ * job gets a thread budget, which caps the openmp threads of the algorithm
+ * (see magical_config::set_thread_limit()); jobs start in submission order as
+ * soon as enough of the executor threads are free, so a large job is not
+ * overtaken indefinitely by smaller ones behind it.
+ */
+class job_executor
+{
+public:
+    /* constructor: threads shared by the jobs (0: threads of job_executor in
+     * magical_config, or the number of cores)
+     */
+    job_executor(unsigned int = 0);
+
+    // destructor: runs the jobs still queued, then stops
+    virtual ~job_executor();
+
+    /* queues the job with the given thread budget (0, or more than the
+     * executor has: all of them) and returns it, as its future
+     */
+    template <class J>
+    J* submit(J *j, unsigned int budget = 0)
+    {
+        enqueue(j, budget);
+        return j;
+    }
+
+    unsigned int get_thread_count() const;
+
+private:
+    static void* worker_loop(void*);
+    void enqueue(job*, unsigned int);
+
+    unsigned int thread_count, free_threads;
+    bool stopping;
+
+    std::vector<pthread_t> workers;
+    std::deque<job*> queue;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;   // a job queued or finished, or stopping
+};
+
+#endif /* __JOBS_H__ */
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "mst.h"
+#include "jobs.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+double tree_weight(AdjacencyList<> *tree)
+{
+    double weight = 0;
+    for (unsigned long u = 1; u<=tree->get_vertex_count(); ++u)
+        for (Edge* it = tree->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            weight += it->get_weight();
+
+    return weight;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 2000, m = 300;
+
+    AdjacencyList<> *g = randomUndirectedGraph(n, 4, 100);
+    AdjacencyList<> *small = randomUndirectedGraph(m, 4, 100);
+
+    job_executor executor(4);
+    errors += check(executor.get_thread_count() == 4, "executor threads");
+
+    // medium-size jobs of every kind, overlapping
+    double start = omp_get_wtime();
+
+    vector<dijkstra_job*> searches;
+    for (unsigned long s = 1; s<=16; ++s)
+        searches.push_back(executor.submit(new dijkstra_job(g, s * 100), 1));
+
+    johnson_job *apsp = executor.submit(new johnson_job(small), 2);
+    boruvka_job *mst = executor.submit(new boruvka_job(g), 2);
+    johnson_job *whole = executor.submit(new johnson_job(small));   // every thread
+
+    for (unsigned long k = 0; k<searches.size(); ++k)
+        searches[k]->wait();
+    whole->wait();
+    double overlapped_time = omp_get_wtime() - start;
+
+    // results against direct calls
+    vector<double> dist(n+1);
+    vector<unsigned long> pred(n+1);
+    for (unsigned long k = 0; k<searches.size(); ++k)
+    {
+        errors += check(searches[k]->succeeded(), "dijkstra job");
+        bellman_ford(g, (k+1) * 100, &dist[0], &pred[0]);
+
+        const sssp_workspace &ws = searches[k]->get_result();
+        for (unsigned long v = 1; v<=n; ++v)
+            errors += check(ws.get_distance(v) == dist[v], "dijkstra job distance");
+    }
+
+    AllPairsResult<> expected(m);
+    johnson(small, &expected);
+    errors += check(apsp->succeeded() && whole->succeeded(), "johnson jobs");
+    for (unsigned long u = 1; u<=m; ++u)
+        for (unsigned long v = 1; v<=m; ++v)
+            errors += check(apsp->get_result().distance(u, v) == expected.distance(u, v)
+                && whole->get_result().distance(u, v) == expected.distance(u, v), "johnson job distance");
+
+    AdjacencyList<> *tree = new AdjacencyList<>(n);
+    boruvka(g, tree);
+    errors += check(mst->succeeded() && tree_weight(mst->get_result()) == tree_weight(tree), "boruvka job");
+
+    cout << searches.size() + 3 << " jobs on " << executor.get_thread_count() << " threads in "
+        << overlapped_time << "s" << endl;
+
+    // euler circuits: a simple cycle, and two cycles through vertex 1
+    AdjacencyList<> *cycle = new AdjacencyList<>(10);
+    for (unsigned long u = 1; u<=10; ++u)
+        cycle->addEdge(u, u % 10 + 1, 1);
+    euler_tour_job *tour = executor.submit(new euler_tour_job(cycle, 10), 1);
+
+    AdjacencyList<> *eight = new AdjacencyList<>(5);
+    eight->addEdge(1, 2, 1); eight->addEdge(2, 3, 1); eight->addEdge(3, 1, 1);
+    eight->addEdge(1, 4, 1); eight->addEdge(4, 5, 1); eight->addEdge(5, 1, 1);
+    euler_tour_job *eight_tour = executor.submit(new euler_tour_job(eight, 6), 1);
+
+    errors += check(tour->succeeded() && tour->get_result().size() == 11, "euler job");
+    for (unsigned long i = 0; i<tour->get_result().size() && i<11; ++i)
+        errors += check(tour->get_result()[i] == i % 10 + 1, "euler job circuit");
+
+    const vector<unsigned long> &circuit = eight_tour->get_result();
+    errors += check(eight_tour->succeeded() && circuit.size() == 7 && circuit.front() == 1
+        && circuit.back() == 1, "two-cycle euler job");
+    vector<int> used(6, 0);
+    for (unsigned long i = 1; i<circuit.size(); ++i)
+    {
+        unsigned long u = circuit[i-1], v = circuit[i];
+        int arc = (u == 1 && v == 2) ? 0 : (u == 2 && v == 3) ? 1 : (u == 3 && v == 1) ? 2
+            : (u == 1 && v == 4) ? 3 : (u == 4 && v == 5) ? 4 : (u == 5 && v == 1) ? 5 : -1;
+        errors += check(arc >= 0 && !used[arc]++, "two-cycle euler job arcs");
+    }
+
+    // a failing job: negative cycle
+    AdjacencyList<> *negative = new AdjacencyList<>(3);
+    negative->addEdge(1, 2, 1);
+    negative->addEdge(2, 1, -2);
+    dijkstra_job *failing = executor.submit(new dijkstra_job(negative, 1), 1);
+    errors += check(!failing->succeeded() && failing->is_done(), "failing job");
+
+    // unknown sources throw on construction
+    bool thrown = false;
+    try {
+        dijkstra_job unknown(g, n+1);
+    } catch (NoSuchVertexException&) {
+        thrown = true;
+    }
+    errors += check(thrown, "unknown source");
+
+    for (unsigned long k = 0; k<searches.size(); ++k)
+        delete searches[k];
+    delete apsp; delete mst; delete whole; delete failing; delete tour; delete eight_tour;
+    delete g; delete small; delete tree; delete negative; delete cycle; delete eight;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
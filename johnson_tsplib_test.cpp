@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include "types.h"
 #include "paths.h"
+#include "tsplib.h"
 
 #include <sys/time.h>       // for 'gettimeofday()'
 #include <sys/resource.h>   // for 'getrusage()'
@@ -43,81 +44,6 @@ void get_timer()
 	
 }
 
-AdjacencyList<>* graph_from_tsplib(const char * filename)
-{
-    // cities coordinates vectors
-    vector<float> xcoord;
-    vector<float> ycoord;
-    xcoord.clear();
-    ycoord.clear();
-	
-    // input file handler
-    ifstream input_fh(filename);
-
-    if (input_fh.is_open())
-    {
-        string line;
-
-        // skips file until the string preciding the first coordinates is found 
-        getline(input_fh, line);
-        while(line.find("NODE_COORD_SECTION") == string::npos)
-        {
-            getline(input_fh, line);
-            //cout << line << endl;
-        }
-
-        // parse each line, until 'end of file' is found
-        getline(input_fh, line);
-        while(line.find("EOF") == string::npos)
-        {
-            float x, y;
-            
-            // reads current coordinates, ignoring the city index
-            sscanf(line.c_str(), "%*d %f %f", &x, &y);
-            
-            xcoord.push_back(x);
-            ycoord.push_back(y);
-            
-            getline(input_fh, line);
-        }
-
-        input_fh.close();
-    }
-    else
-    {
-        cerr << "ERROR: Could not open file (might not exist)." << endl;
-        return(0);
-    }
-
-    //cout << "completed reading tsplib file" << endl;
-    //cout << "# cities: " << xcoord.size() << endl;
-
-    // creates graph corresponding to this TSP instance
-    unsigned long num_vertices = xcoord.size();
-    AdjacencyList<> *graph = new AdjacencyList<>(num_vertices);
-
-    // in the case of constructing a sparse graph
-    //srand (time(0));
-
-    for (unsigned int i = 0; i<num_vertices; ++i)
-    {
-        for (unsigned int j = 0; j<num_vertices; ++j)
-        {
-            // euclidean distance between cities i and j
-            double xd = xcoord[i] - xcoord[j];
-            double yd = ycoord[i] - ycoord[j];
-            double dij = floor( sqrt(pow(xd,2)+pow(yd,2)) + 0.5 );
-
-            // inserts an arc joining i and j, with weight = dij
-            //if ((rand() % 100) < 10)      // sparsity: 10% of the edges only
-            graph->addEdge(i+1, j+1, dij);
-        }
-    }
-
-    return graph;
-}
-
-
 int main(int argc, char** argv)
 {
     if (argc < 2)
@@ -141,27 +67,30 @@ int main(int argc, char** argv)
 
     unsigned long num_vertices = graph->get_vertex_count();
     
-    // 'distances' and 'paths': result data structures (with dummy node at head)
-    double **distances = new double* [num_vertices+1];
-    vector<unsigned long> **paths = new vector<unsigned long>* [num_vertices+1];
+    // 'result': distance and predecessor matrices, paths rebuilt on demand
+    AllPairsResult<> *result = new AllPairsResult<>(num_vertices);
+
+    parallel_profile profile;
+    negative_cycle cycle;
 
-    for (unsigned long n = 0; n<num_vertices+1; ++n)
+    if (johnson(graph, result, &profile, &cycle) == false)
     {
-        distances[n] = new double[num_vertices+1];
-        paths[n] = new vector<unsigned long>[num_vertices+1];
+        cout << "negative-weight cycle detected (" << cycle.vertices.size()
+            << " vertices, weight " << cycle.weight << "):";
+        for (unsigned long i = 0; i<cycle.vertices.size(); ++i)
+            cout << " " << cycle.vertices[i];
+        cout << endl;
     }
-
-    if (johnson(graph, distances, paths) == false)
-        cout << "negative-weight cycle detected" << endl;
-
-    // clean-up
-    for (unsigned long n = 0; n<num_vertices+1; ++n)
+    else
     {
-        delete[] distances[n];
-        delete[] paths[n];
+        // load balance: busy time of each thread against the loop wall time
+        for (unsigned long t = 0; t<profile.busy_time.size(); ++t)
+            printf("thread #%lu: %lu sources, busy %.6f of %.6f\n", t,
+                profile.iterations[t], profile.busy_time[t], profile.wall_time);
     }
-    delete[] distances;
-    delete[] paths;
+
+    // clean-up
+    delete result;
     delete graph;
 
 	// -- time evaluation (finish) ---------------------------------------------
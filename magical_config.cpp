@@ -2,6 +2,7 @@
 #include <climits>
 #include <cstdlib>
 #include <omp.h>
+#include <pthread.h>   // for pthread_once
 
 #define ulong unsigned long
 
@@ -11,8 +12,13 @@ namespace magical_config
     // prevents permanent (xml file) setting to override dynamic (api functions)
     static bool threads_manually_set = false;
 
-    // prevents parsing the file again (unnecessarily)
-    static bool file_already_loaded = false;
+    /* parses the file once, even when the first callers are concurrent: the
+     * others wait until the settings are complete
+     */
+    static pthread_once_t file_once = PTHREAD_ONCE_INIT;
+
+    // cap on the threads of each algorithm, per calling thread (0: none)
+    static __thread unsigned int thread_limit = 0;
 
     /* IMPORTANT: when including an algorithm in the library, please include a
      * corresponding namespace here too.
@@ -35,12 +41,221 @@ namespace magical_config
         map<pair<ulong,ulong>,string> threads;
     }
     
+    namespace contraction
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace alt
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace many_to_many
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace bellman_ford
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace floyd_warshall
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace hub_labels
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace yen
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace batched
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace bfs
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace analysis
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace dense
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace voronoi
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace server
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
+    namespace jobs
+    {
+        map<string, string> defaults;
+        map<pair<ulong,ulong>,string> threads;
+    }
+    
     void set_threads(unsigned int thr_count)
     {
         threads_manually_set = true;
         omp_set_num_threads(thr_count);
     }
     
+    void set_thread_limit(unsigned int thr_count)
+    {
+        thread_limit = thr_count;
+    }
+
+    // sets the openmp threads of the calling thread, within its cap
+    static void apply_threads(ulong thr)
+    {
+        if (thread_limit != 0 && thr > thread_limit)
+            thr = thread_limit;
+
+        omp_set_num_threads(thr);
+    }
+    
+    /* IMPORTANT: when including a new algorithm, please register a
+     * corresponding entry here (to use algorithm-specific settings)
+     */
+    static bool find_algorithm(const char *algorithm,
+        map<string, string> **defaults_ptr, map<pair<ulong,ulong>,string> **threads_ptr)
+    {
+        if(strcmp(algorithm, "johnson") == 0)
+        {
+            *defaults_ptr = &(johnson::defaults);
+            *threads_ptr  = &(johnson::threads);
+        }
+        else if(strcmp(algorithm, "boruvka") == 0)
+        {
+            *defaults_ptr = &(boruvka::defaults);
+            *threads_ptr  = &(boruvka::threads);
+        }
+        else if(strcmp(algorithm, "hierholzer") == 0)
+        {
+            *defaults_ptr = &(hierholzer::defaults);
+            *threads_ptr  = &(hierholzer::threads);
+        }
+        else if(strcmp(algorithm, "contraction") == 0)
+        {
+            *defaults_ptr = &(contraction::defaults);
+            *threads_ptr  = &(contraction::threads);
+        }
+        else if(strcmp(algorithm, "alt") == 0)
+        {
+            *defaults_ptr = &(alt::defaults);
+            *threads_ptr  = &(alt::threads);
+        }
+        else if(strcmp(algorithm, "many_to_many") == 0)
+        {
+            *defaults_ptr = &(many_to_many::defaults);
+            *threads_ptr  = &(many_to_many::threads);
+        }
+        else if(strcmp(algorithm, "bellman_ford") == 0)
+        {
+            *defaults_ptr = &(bellman_ford::defaults);
+            *threads_ptr  = &(bellman_ford::threads);
+        }
+        else if(strcmp(algorithm, "floyd_warshall") == 0)
+        {
+            *defaults_ptr = &(floyd_warshall::defaults);
+            *threads_ptr  = &(floyd_warshall::threads);
+        }
+        else if(strcmp(algorithm, "hub_labels") == 0)
+        {
+            *defaults_ptr = &(hub_labels::defaults);
+            *threads_ptr  = &(hub_labels::threads);
+        }
+        else if(strcmp(algorithm, "yen") == 0)
+        {
+            *defaults_ptr = &(yen::defaults);
+            *threads_ptr  = &(yen::threads);
+        }
+        else if(strcmp(algorithm, "batched") == 0)
+        {
+            *defaults_ptr = &(batched::defaults);
+            *threads_ptr  = &(batched::threads);
+        }
+        else if(strcmp(algorithm, "bfs") == 0)
+        {
+            *defaults_ptr = &(bfs::defaults);
+            *threads_ptr  = &(bfs::threads);
+        }
+        else if(strcmp(algorithm, "analysis") == 0)
+        {
+            *defaults_ptr = &(analysis::defaults);
+            *threads_ptr  = &(analysis::threads);
+        }
+        else if(strcmp(algorithm, "dense") == 0)
+        {
+            *defaults_ptr = &(dense::defaults);
+            *threads_ptr  = &(dense::threads);
+        }
+        else if(strcmp(algorithm, "voronoi") == 0)
+        {
+            *defaults_ptr = &(voronoi::defaults);
+            *threads_ptr  = &(voronoi::threads);
+        }
+        else if(strcmp(algorithm, "server") == 0)
+        {
+            *defaults_ptr = &(server::defaults);
+            *threads_ptr  = &(server::threads);
+        }
+        else if(strcmp(algorithm, "jobs") == 0)
+        {
+            *defaults_ptr = &(jobs::defaults);
+            *threads_ptr  = &(jobs::threads);
+        }
+        else
+        {
+            // could not match given string
+            return false;
+        }
+
+        return true;
+    }
+
+    static void parse_file_once()
+    {
+        parse_file();
+    }
+
+    // parse xml file if not done yet
+    static void load_file()
+    {
+        pthread_once(&file_once, parse_file_once);
+    }
+
     bool load_settings(const char *algorithm, ulong input_size)
     {
         /* input_size is algorithm-dependent (e.g. #vertices, #edges), but must
@@ -49,39 +264,13 @@ namespace magical_config
         
         if (!threads_manually_set)
         {
-            // parse xml file if not done yet
-            if (!file_already_loaded)
-            {
-                file_already_loaded = true;
-                parse_file();
-            }
+            load_file();
             
-            /* IMPORTANT: when including a new algorithm, please register a
-             * corresponding entry here (to use algorithm-specific settings)
-             */
             map<string, string> *defaults_ptr = 0;
             map<pair<ulong,ulong>,string> *threads_ptr = 0;
             
-            if(strcmp(algorithm, "johnson") == 0)
-            {
-                defaults_ptr = &(johnson::defaults);
-                threads_ptr  = &(johnson::threads);
-            }
-            else if(strcmp(algorithm, "boruvka") == 0)
-            {
-                defaults_ptr = &(boruvka::defaults);
-                threads_ptr  = &(boruvka::threads);
-            }
-            else if(strcmp(algorithm, "hierholzer") == 0)
-            {
-                defaults_ptr = &(hierholzer::defaults);
-                threads_ptr  = &(hierholzer::threads);
-            }
-            else
-            {
-                // could not match given string
+            if (!find_algorithm(algorithm, &defaults_ptr, &threads_ptr))
                 return false;
-            }
             
             // define settings according to specific configuration
             map<pair<ulong, ulong>,string>::iterator it;
@@ -94,20 +283,122 @@ namespace magical_config
                 if (input_size >= interval.first && input_size <= interval.second)
                 {
                     ulong thr = (*it).second.compare("#cores") == 0 ? omp_get_num_procs() : atoi((*it).second.c_str());
-                    omp_set_num_threads(thr);
+                    apply_threads(thr);
                     return true;
                 }
             }
             
             // no entry regarding current size was found .: use default settings
-            ulong thr = (*defaults_ptr)["threads"].compare("#cores") == 0 ? omp_get_num_procs() : atoi((*defaults_ptr)["threads"].c_str());
-            omp_set_num_threads(thr);
+            // (find, not operator[]: concurrent calls must not insert)
+            map<string, string>::iterator def = defaults_ptr->find("threads");
+            string setting = (def == defaults_ptr->end()) ? "" : def->second;
+            ulong thr = (setting.empty() || setting.compare("#cores") == 0) ? omp_get_num_procs() : atoi(setting.c_str());
+            apply_threads(thr);
             return true;
         }
         
+        apply_threads(omp_get_max_threads());
         return true;   // manual settings
     }
     
+    string get_setting(const char *algorithm, const char *key)
+    {
+        load_file();
+
+        map<string, string> *defaults_ptr = 0;
+        map<pair<ulong,ulong>,string> *threads_ptr = 0;
+
+        if (!find_algorithm(algorithm, &defaults_ptr, &threads_ptr))
+            return "";
+
+        map<string, string>::iterator it = defaults_ptr->find(key);
+        return (it == defaults_ptr->end()) ? "" : it->second;
+    }
+
+    void load_schedule(const char *algorithm)
+    {
+        // "kind[,chunk]", e.g. "dynamic,4"; unset or unknown kinds: dynamic
+        string setting = get_setting(algorithm, "schedule");
+        string kind = setting.substr(0, setting.find(','));
+        int chunk = 0;   // openmp default for the kind
+        if (setting.find(',') != string::npos)
+            chunk = atoi(setting.substr(setting.find(',')+1).c_str());
+
+        if (kind.compare("static") == 0)
+            omp_set_schedule(omp_sched_static, chunk);
+        else if (kind.compare("guided") == 0)
+            omp_set_schedule(omp_sched_guided, chunk);
+        else
+            omp_set_schedule(omp_sched_dynamic, chunk);
+    }
+
+    /* parses the block describing the settings of one algorithm, e.g.
+     *   <johnson_shortest_paths>
+     *       <default threads="#cores"/>
+     *       <input min_vertices="301" max_vertices="701" threads="2"/>
+     *   </johnson_shortest_paths>
+     */
+    static void parse_algorithm(TiXmlHandle &hRoot, const char *tag,
+        map<string, string> &defaults, map<pair<ulong,ulong>,string> &threads)
+    {
+        TiXmlElement* pElem = hRoot.FirstChild(tag).FirstChild().Element();
+
+        // set all default values (possibly overridden below)
+        defaults["threads"] = "#cores";
+
+        while (pElem)
+        {
+            const char *pKey = pElem->Value();
+            const char *pVal;
+
+            if (pKey)
+            {
+                if (strcmp(pKey, "default") == 0)
+                {
+                    // every attribute is kept (e.g. threads, schedule)
+                    const TiXmlAttribute *pAttrib = pElem->FirstAttribute();
+                    while (pAttrib)
+                    {
+                        defaults[pAttrib->Name()] = pAttrib->Value();
+                        pAttrib = pAttrib->Next();
+                    }
+                }
+                else if(strcmp(pKey, "input") == 0)
+                {
+                    // min value
+                    ulong min = 0;
+                    pKey = 0;
+                    pKey = pElem->Attribute("min_vertices");
+                    if (pKey)
+                        min = atol(pKey);
+
+                    // max value
+                    ulong max = ULONG_MAX;
+                    pKey = 0;
+                    pKey = pElem->Attribute("max_vertices");
+                    if (pKey)
+                        max = atol(pKey);
+
+                    // config value
+                    pVal = pElem->Attribute("threads");
+                    if (pVal)
+                        threads[make_pair(min,max)] = pVal;
+                }
+                else
+                {
+                    // current behavior: ignore unexpected elements
+                }
+            }
+            else
+            {
+                // should not reach here: element has no name/value?
+            }
+
+            // next sibling entry (another setting for this algorithm)
+            pElem = pElem->NextSiblingElement();
+        }
+    }
+
     bool parse_file()
     {
     	TiXmlDocument doc(_MAGICAL_CONFIG_FILE);
@@ -132,183 +423,44 @@ namespace magical_config
     		hRoot=TiXmlHandle(pElem);
     	}
     
-        ////////////////////////////////////////////
-        // block: Johnson's All-Pairs Shortest-Paths
-    	{
-    		pElem =
-    		    hRoot.FirstChild("johnson_shortest_paths").FirstChild().Element();
-		
-    		if (!pElem)
-    		{
-    		    // set all default values
-    		    magical_config::johnson::defaults["threads"] = "#cores";
-    		}
-		
-    		while (pElem)
-    		{
-    			const char *pKey = pElem->Value();
-                const char *pVal;
-            
-    			if (pKey)
-    			{
-    			    if (strcmp(pKey, "default") == 0)
-    			    {
-    			        pVal = pElem->Attribute("threads");
-                        magical_config::johnson::defaults["threads"] = pVal;
-    			    }
-    			    else if(strcmp(pKey, "input") == 0)
-    			    {
-    			        // min value
-    			        ulong min = 0;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("min_vertices");
-    			        if (pKey)
-                            min = atol(pKey);
-
-    			        // max value
-                        ulong max = ULONG_MAX;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("max_vertices");
-    			        if (pKey)
-                            max = atol(pKey);
-                    
-                        // config value
-                        pVal = pElem->Attribute("threads");
-                        magical_config::johnson::threads[make_pair(min,max)] = pVal;
-    			    }
-    			    else
-    			    {
-    			        // current behavior: ignore unexpected elements
-    			    }
-    			}
-    			else
-    			{
-    			    // should not reach here: element has no name/value?
-    			}
-			
-    			// next sibling entry (another setting for this algorithm)
-                pElem = pElem->NextSiblingElement();
-    		}
-    	}
-	
-    	/////////////////////////////////////////
-        // block: Boruvka's Minimum Spanning Tree
-    	{
-    		pElem =
-    		    hRoot.FirstChild("boruvka_mst").FirstChild().Element();
-		
-    		if (!pElem)
-    		{
-    		    // set all default values
-    		    magical_config::boruvka::defaults["threads"] = "#cores";
-    		}
-		
-    		while (pElem)
-    		{
-    			const char *pKey = pElem->Value();
-                const char *pVal;
-            
-    			if (pKey)
-    			{
-    			    if (strcmp(pKey, "default") == 0)
-    			    {
-    			        pVal = pElem->Attribute("threads");
-                        magical_config::boruvka::defaults["threads"] = pVal;
-    			    }
-    			    else if(strcmp(pKey, "input") == 0)
-    			    {
-    			        // min value
-    			        ulong min = 0;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("min_vertices");
-    			        if (pKey)
-                            min = atol(pKey);
-
-    			        // max value
-                        ulong max = ULONG_MAX;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("max_vertices");
-    			        if (pKey)
-                            max = atol(pKey);
-                    
-                        // config value
-                        pVal = pElem->Attribute("threads");
-                        magical_config::boruvka::threads[make_pair(min,max)] = pVal;
-    			    }
-    			    else
-    			    {
-    			        // current behavior: ignore unexpected elements
-    			    }
-    			}
-    			else
-    			{
-    			    // should not reach here: element has no name/value?
-    			}
-            
-    			// next sibling entry (another setting for this algorithm)
-                pElem = pElem->NextSiblingElement();
-    		}
-    	}
-	
-    	///////////////////////////////////////
-        // block: Hierholzer's Eulerian Circuit
-    	{
-    		pElem =
-    		hRoot.FirstChild("hierholzer_eulerian_circuit").FirstChild().Element();
-		
-    		if (!pElem)
-    		{
-    		    // set all default values
-    		    magical_config::hierholzer::defaults["threads"] = "#cores";
-    		}
-		
-    		while (pElem)
-    		{
-    			const char *pKey = pElem->Value();
-                const char *pVal;
-            
-    			if (pKey)
-    			{
-    			    if (strcmp(pKey, "default") == 0)
-    			    {
-    			        pVal = pElem->Attribute("threads");
-                        magical_config::hierholzer::defaults["threads"] = pVal;
-    			    }
-    			    else if(strcmp(pKey, "input") == 0)
-    			    {
-    			        // min value
-    			        ulong min = 0;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("min_vertices");
-    			        if (pKey)
-                            min = atol(pKey);
+        /* IMPORTANT: when including a new algorithm, please parse its block
+         * here too (xml element name, then the corresponding namespace)
+         */
+        parse_algorithm(hRoot, "johnson_shortest_paths",
+            johnson::defaults, johnson::threads);
+        parse_algorithm(hRoot, "boruvka_mst",
+            boruvka::defaults, boruvka::threads);
+        parse_algorithm(hRoot, "hierholzer_eulerian_circuit",
+            hierholzer::defaults, hierholzer::threads);
+        parse_algorithm(hRoot, "contraction_hierarchies",
+            contraction::defaults, contraction::threads);
+        parse_algorithm(hRoot, "alt_landmarks",
+            alt::defaults, alt::threads);
+        parse_algorithm(hRoot, "many_to_many_distances",
+            many_to_many::defaults, many_to_many::threads);
+        parse_algorithm(hRoot, "bellman_ford_shortest_paths",
+            bellman_ford::defaults, bellman_ford::threads);
+        parse_algorithm(hRoot, "floyd_warshall_shortest_paths",
+            floyd_warshall::defaults, floyd_warshall::threads);
+        parse_algorithm(hRoot, "hub_labeling",
+            hub_labels::defaults, hub_labels::threads);
+        parse_algorithm(hRoot, "yen_k_shortest_paths",
+            yen::defaults, yen::threads);
+        parse_algorithm(hRoot, "multi_source_batches",
+            batched::defaults, batched::threads);
+        parse_algorithm(hRoot, "direction_optimizing_bfs",
+            bfs::defaults, bfs::threads);
+        parse_algorithm(hRoot, "graph_analysis",
+            analysis::defaults, analysis::threads);
+        parse_algorithm(hRoot, "dense_dijkstra",
+            dense::defaults, dense::threads);
+        parse_algorithm(hRoot, "voronoi",
+            voronoi::defaults, voronoi::threads);
+        parse_algorithm(hRoot, "query_server",
+            server::defaults, server::threads);
+        parse_algorithm(hRoot, "job_executor",
+            jobs::defaults, jobs::threads);
 
-    			        // max value
-                        ulong max = ULONG_MAX;
-    			        pKey = 0;
-    			        pKey = pElem->Attribute("max_vertices");
-    			        if (pKey)
-                            max = atol(pKey);
-                    
-                        // config value
-                        pVal = pElem->Attribute("threads");
-                        magical_config::hierholzer::threads[make_pair(min,max)] = pVal;
-    			    }
-    			    else
-    			    {
-    			        // current behavior: ignore unexpected elements
-    			    }
-    			}
-    			else
-    			{
-    			    // should not reach here: element has no name/value?
-    			}
-			
-    			// next sibling entry (another setting for this algorithm)
-                pElem = pElem->NextSiblingElement();
-    		}
-    	}
-	
     	///////////////////
     	// parsing complete
         return true;
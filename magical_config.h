@@ -37,12 +37,109 @@ namespace magical_config
         extern map<pair<unsigned long, unsigned long>,string> threads;
     }
     
+    namespace contraction
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace alt
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace many_to_many
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace bellman_ford
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace floyd_warshall
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace hub_labels
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace yen
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace batched
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace bfs
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace analysis
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace dense
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace voronoi
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace server
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
+    namespace jobs
+    {
+        extern map<string, string> defaults;
+        extern map<pair<unsigned long, unsigned long>,string> threads;
+    }
+    
     // api for manually setting options (allows dynamic changing configuration)
     void set_threads(unsigned int);
     
+    /* caps the threads of the algorithms run from the calling thread (0 lifts
+     * the cap), e.g. for the workers of a server sharing the cores
+     */
+    void set_thread_limit(unsigned int);
+    
     // shall be called by every library algorithm to load the configuration
     bool load_settings(const char*, unsigned long);
     
+    // value of an algorithm setting from its 'default' element ("" if unset)
+    string get_setting(const char*, const char*);
+    
+    /* sets the openmp schedule of the algorithm loops declared as
+     * schedule(runtime), from its "schedule" setting (e.g. "guided,4")
+     */
+    void load_schedule(const char*);
+    
     // reads xml configuration file specifying the parallel execution settings
     bool parse_file();
 }
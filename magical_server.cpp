@@ -0,0 +1,90 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <pthread.h>
+#include <unistd.h>    // for getopt
+#include "types.h"
+#include "tsplib.h"
+#include "snapshot.h"
+#include "query_server.h"
+
+using namespace std;
+
+/* query daemon: loads a graph once (a TSPLIB instance, or a snapshot) and
+ * serves queries on it at a Unix-domain socket until SIGINT or SIGTERM
+ *
+ *   magical_server [-w workers] [-s snapshot] graph_file socket_path
+ *
+ * -s saves the graph as a snapshot (e.g. to load a TSPLIB instance faster
+ * next time) before serving
+ */
+
+static void usage(const char *program)
+{
+    cerr << "usage: " << program << " [-w workers] [-s snapshot] graph_file socket_path" << endl;
+}
+
+static bool ends_with(const char *s, const char *suffix)
+{
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int workers = 0;
+    const char *snapshot = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:s:")) != -1)
+    {
+        if (opt == 'w')
+            workers = atoi(optarg);
+        else if (opt == 's')
+            snapshot = optarg;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *graph_file = argv[optind], *socket_path = argv[optind+1];
+    AdjacencyList<> *graph = ends_with(graph_file, ".tsp") ? graph_from_tsplib(graph_file)
+        : graph_from_snapshot(graph_file);
+    if (!graph)
+        return 1;
+
+    if (snapshot && !save_snapshot(graph, snapshot))
+        return 1;
+
+    // signals are taken by sigwait below, not by the server threads
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+    query_server server(graph);
+    if (!server.start(socket_path, workers))
+        return 1;
+
+    cout << "serving " << graph->get_vertex_count() << " vertices at " << socket_path << endl;
+
+    int sig;
+    sigwait(&signals, &sig);
+    server.stop();
+
+    cout << server.get_answered_count() << " queries answered ("
+        << server.get_batched_count() << " batched)" << endl;
+
+    delete graph;
+    return 0;
+}
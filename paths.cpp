@@ -1,9 +1,22 @@
 #include "paths.h"
 #include <cmath>   // for floor
 #include <cfloat>  // for DBL_MAX
+#include <climits> // for ULONG_MAX
 #include <omp.h>
 #include <iostream>
+#include <algorithm>
+#include <set>
+#include <iterator> // for advance
+#include <cstdlib> // for atol, atof
+#include <cstdio>  // for fopen, fwrite
 #include "magical_config.h"
+#include "batched_paths.h"
+#include "bfs.h"
+#include "analysis.h"
+#include "dense_paths.h"
+#ifdef __AVX2__
+#include <immintrin.h>   // min-plus kernel of floyd-warshall
+#endif
 //#include <sched.h>   // for linux 'sched_getcpu()' function
 
 /*
@@ -175,8 +188,46 @@ private:
  * Dijkstra's implementation
  */
 void dijkstra(AdjacencyList<> *graph, unsigned long source, double dist[], std::vector<unsigned long> paths[])
+{
+    const graph_properties &p = analyze_graph(graph);
+    if (p.uniform && p.min_weight >= 0)
+    {
+        parallel_bfs bfs(graph);
+        dijkstra(graph, source, dist, paths, &bfs);
+    }
+    else
+        dijkstra(graph, source, dist, paths, 0);
+}
+
+void dijkstra(AdjacencyList<> *graph, unsigned long source, double dist[], std::vector<unsigned long> paths[],
+    parallel_bfs *bfs)
 {
     unsigned long num_vertices = graph->get_vertex_count();
+
+    // every arc alike: hop counts of a parallel breadth-first search
+    const graph_properties &p = analyze_graph(graph);
+    if (bfs && p.uniform && p.min_weight >= 0)
+    {
+        double weight = p.min_weight;
+        std::vector<unsigned long> levels(num_vertices+1), parents(num_vertices+1);
+        bfs->run(source, &levels[0], &parents[0]);
+
+        for (unsigned long v = 1; v<=num_vertices; ++v)
+        {
+            paths[v].clear();
+            dist[v] = (levels[v] == ULONG_MAX) ? DBL_MAX : levels[v] * weight;
+            if (levels[v] == ULONG_MAX)
+                continue;
+
+            for (unsigned long x = v; x != 0; x = parents[x])
+                paths[v].push_back(x);
+            std::reverse(paths[v].begin(), paths[v].end());
+        }
+
+        return;
+    }
+
+
     binary_min_heap queue;   // Q in Dijkstra algorithm presented in Cormen et al.
 
 /*    //print graph
@@ -263,203 +314,1355 @@ void dijkstra(AdjacencyList<> *graph, unsigned long source, double dist[], std::
 }
 
 /*
- * Bellman-Ford's implementation
+ * Bounded Dijkstra's implementation: a single kernel settles vertices from the
+ * workspace queue until one of the stopping criteria holds
  */
-bool bellman_ford(AdjacencyList<> *graph, unsigned long source, double dist[], std::vector<unsigned long> paths[])
+static unsigned long bounded_dijkstra(AdjacencyList<> *graph, unsigned long source,
+    sssp_workspace *ws, double radius, unsigned long max_settled, unsigned long targets_left,
+    const double *potential = 0)
 {
-    unsigned long num_vertices = graph->get_vertex_count();
+    graph->get_vertex(source);   // throws NoSuchVertexException
 
-    // initialize_single_source: shortest path estimate and paths for each vertex
-    for (unsigned long i = 1; i<=num_vertices; ++i)
-    {
-        dist[i] = DBL_MAX;
-        paths[i].clear();
-    }
-    dist[source] = 0;
-    paths[source].push_back(source);
+    ws->reset();
+    ws->add_source(source);
 
-    // algorithm kernel: relax all arcs n-1 times
-    for (unsigned long i = 1; i<num_vertices; ++i)
+    unsigned long num_settled = 0;
+    while (ws->has_next() && ws->next_key() <= radius)
     {
-        // iteration is complete if no arc is relaxed
-        bool complete = true;
-        
-        // for each arc (u,v) in E
-        for (unsigned long u = 1; u<=num_vertices; ++u)
+        unsigned long u = ws->settle_next();
+        double du = ws->get_distance(u);
+
+        // k-nearest: the source itself is not counted
+        if (u != source)
+            ++num_settled;
+
+        if (num_settled == max_settled)
+            break;
+
+        if (ws->is_marked(u) && --targets_left == 0)
+            break;
+
+        Edge* adj = graph->get_vertex(u)->get_adjacencies();
+        while (adj)
         {
-            Edge* it = graph->get_vertex(u)->get_adjacencies();
-            while (it)
-            {
-                // current adjacency information
-                unsigned long v = it->get_successor()->get_key();
-                double w = it->get_weight();
+            unsigned long v = adj->get_successor()->get_key();
+            double w = adj->get_weight();
 
-                // relax arc(u,v)
-                if (dist[u] + w < dist[v])
-                {
-                    dist[v] = dist[u] + w;
-
-                    // saves path: antecessor path + goal vertex (v)
-                    paths[v] = paths[u];
-                    paths[v].push_back(v);
-                    
-                    // as long as any arc gets relaxed, iteration is not complete
-                    complete = false;
-                }
+            // reduced cost w + h[u] - h[v] (nonnegative, but for rounding)
+            if (potential)
+                w = std::max(0.0, w + potential[u] - potential[v]);
 
-                it = it->get_next();   // next edge
-            }
+            // relax arc(u,v), ignoring estimates beyond the radius
+            double d = du + w;
+            if (d <= radius)
+                ws->relax(v, d, u);
+
+            adj = adj->get_next();   // next edge
         }
-        
-        if (complete)
-            return true;
     }
 
-    /* check each arc (u,v) in E one more time: if there is any arc leading to a
-     * shorter path after n-1 iterations, then exists a negative-weight cycle
-     */
-    for (unsigned long u = 1; u<=num_vertices; ++u)
+    return ws->get_settled().size();
+}
+
+/* breadth-first search settling vertices straight into the workspace, whose
+ * settled list serves as the queue: exact while every arc scanned has the same
+ * nonnegative weight, hence it gives up (returning false) at the first arc
+ * which differs
+ */
+static bool breadth_first(AdjacencyList<> *graph, unsigned long source, sssp_workspace *ws)
+{
+    graph->get_vertex(source);   // throws NoSuchVertexException
+
+    ws->reset();
+    ws->settle(source, 0, 0);
+
+    double weight = -1;   // of every arc, once the first one is seen
+    const std::vector<unsigned long> &order = ws->get_settled();
+
+    for (unsigned long k = 0; k<order.size(); ++k)
     {
-        Edge* it = graph->get_vertex(u)->get_adjacencies();
-        while (it)
+        unsigned long u = order[k];
+        double du = ws->get_distance(u);
+
+        Edge* adj = graph->get_vertex(u)->get_adjacencies();
+        while (adj)
         {
-            // current adjacency information
-            unsigned long v = it->get_successor()->get_key();
-            double w = it->get_weight();
+            if (adj->get_weight() != weight)
+            {
+                if (weight >= 0 || adj->get_weight() < 0)
+                    return false;
+                weight = adj->get_weight();
+            }
 
-            // is it possible to relax arc(u,v)?
-            if (dist[u] + w < dist[v])
-                return false;
+            unsigned long v = adj->get_successor()->get_key();
+            if (ws->get_distance(v) == DBL_MAX)
+                ws->settle(v, du + weight, u);
 
-            it = it->get_next();   // next edge
+            adj = adj->get_next();   // next edge
         }
     }
 
     return true;
 }
 
+void dijkstra(AdjacencyList<> *graph, unsigned long source, sssp_workspace *ws)
+{
+    // graphs whose arcs weigh the same need no queue
+    if (!breadth_first(graph, source, ws))
+        bounded_dijkstra(graph, source, ws, DBL_MAX, ULONG_MAX, ULONG_MAX);
+}
+
+void dijkstra(AdjacencyList<> *graph, unsigned long source, sssp_workspace *ws, const double *potential)
+{
+    bounded_dijkstra(graph, source, ws, DBL_MAX, ULONG_MAX, ULONG_MAX, potential);
+}
+
+unsigned long dijkstra_to_targets(AdjacencyList<> *graph, unsigned long source,
+    const std::vector<unsigned long> &targets, sssp_workspace *ws)
+{
+    // every key first, so that nothing is left marked if one throws
+    graph->get_vertex(source);   // throws NoSuchVertexException
+    for (unsigned long i = 0; i<targets.size(); ++i)
+        graph->get_vertex(targets[i]);   // throws NoSuchVertexException
+
+    // mark targets, counting each of them once
+    unsigned long targets_left = 0;
+    for (unsigned long i = 0; i<targets.size(); ++i)
+    {
+        if (!ws->is_marked(targets[i]))
+        {
+            ws->mark(targets[i]);
+            ++targets_left;
+        }
+    }
+
+    unsigned long num_settled = 0;
+    if (targets_left > 0)
+        num_settled = bounded_dijkstra(graph, source, ws, DBL_MAX, ULONG_MAX, targets_left);
+    else
+        ws->reset();   // no search, but no stale results either
+
+    for (unsigned long i = 0; i<targets.size(); ++i)
+        ws->unmark(targets[i]);
+
+    return num_settled;
+}
+
+unsigned long dijkstra_within_radius(AdjacencyList<> *graph, unsigned long source,
+    double radius, sssp_workspace *ws)
+{
+    return bounded_dijkstra(graph, source, ws, radius, ULONG_MAX, ULONG_MAX);
+}
+
+unsigned long dijkstra_k_nearest(AdjacencyList<> *graph, unsigned long source,
+    unsigned long k, sssp_workspace *ws)
+{
+    return bounded_dijkstra(graph, source, ws, DBL_MAX, k, ULONG_MAX);
+}
 
 /*
- * Johnson's implementation
+ * Many-to-many implementation
+ */
+
+/* row sink copying the target entries of each row into the table, at every
+ * position of its source (sources may repeat)
  */
-bool johnson(AdjacencyList<> *graph, double **dist, std::vector<unsigned long> **paths)
+class table_sink : public apsp_row_sink
+{
+public:
+    table_sink(const std::vector<unsigned long> &s, const std::vector<unsigned long> &t, double *table)
+    : targets(t)
+    {
+        entries = table;
+        positions.resize(s.size());
+        for (unsigned long i = 0; i<s.size(); ++i)
+            positions[i] = std::make_pair(s[i], i);
+        std::sort(positions.begin(), positions.end());
+    }
+
+    void store_row(unsigned long u, const double *d, const unsigned long*)
+    {
+        std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it;
+        it = std::lower_bound(positions.begin(), positions.end(), std::make_pair(u, 0UL));
+
+        for (; it != positions.end() && it->first == u; ++it)
+        {
+            double *row = entries + it->second * targets.size();
+            for (unsigned long j = 0; j<targets.size(); ++j)
+                row[j] = d[targets[j]];
+        }
+    }
+
+private:
+    const std::vector<unsigned long> &targets;
+    std::vector<std::pair<unsigned long, unsigned long> > positions;   // (source, row), sorted
+    double *entries;
+};
+
+void many_to_many(AdjacencyList<> *graph, const std::vector<unsigned long> &sources,
+    const std::vector<unsigned long> &targets, double *table)
 {
+    unsigned long num_vertices = graph->get_vertex_count();
+    long num_sources = sources.size();
+    unsigned long num_targets = targets.size();
+
+    // keys are checked here: an exception cannot leave the parallel region
+    for (long i = 0; i<num_sources; ++i)
+        graph->get_vertex(sources[i]);   // throws NoSuchVertexException
+    for (unsigned long j = 0; j<num_targets; ++j)
+        graph->get_vertex(targets[j]);
+
+    // enough sources to fill the lanes of the batched engine
+    std::string min_sources = magical_config::get_setting("batched", "min_sources");
+    if (num_sources >= (min_sources.empty() ? 64 : atol(min_sources.c_str())) && batched_weights(graph))
+    {
+        table_sink sink(sources, targets, table);
+        batched_distances(graph, sources, &sink);
+        return;
+    }
+
     // openmp setup
-    if ( !magical_config::load_settings("johnson", graph->get_vertex_count()) )
+    if ( !magical_config::load_settings("many_to_many", num_vertices) )
     {
         std::cout << "Could not load settings from magical_config."
             << "Using default values." << endl;
-        
+
         omp_set_num_threads(omp_get_num_procs());
     }
-    
-    /* "producing nonnegative weights (while preserving shortest paths) by
-     * reweighting" (see Cormen et al. 2001): insert artificial vertex 's' in
-     * the graph, and 0-weight edges from 's' to every other vertex
-     */
-    unsigned long old_num_vertices = graph->get_vertex_count();
-    unsigned long new_num_vertices = old_num_vertices + 1;
-    unsigned long s = new_num_vertices;
-    graph->addVertices(1);
-    for (unsigned long i = 1; i <= old_num_vertices; ++i)
-        graph->addEdge(s, i, 0);
-
-    /* let h[i] be the weight of the shortest path between vertices 's' and 'i',
-     * determined through Bellman-Ford's algorithm
-     */
-    double *h = new double[new_num_vertices+1];
-    std::vector<unsigned long> *bf_paths = new std::vector<unsigned long>[new_num_vertices+1];
 
-    if (bellman_ford(graph, s, h, bf_paths) == false)
+    #pragma omp parallel default(none) shared(graph, sources, targets, table, num_vertices, num_sources, num_targets)
     {
-        // negative-weight cycle detected
-        delete[] h;
-        delete[] bf_paths;
-        return false;
+        // per-thread workspace, reused by every source this thread handles
+        sssp_workspace ws(num_vertices);
+
+        #pragma omp for schedule(dynamic)
+        for (long i = 0; i < num_sources; ++i)
+        {
+            dijkstra_to_targets(graph, sources[i], targets, &ws);
+
+            double *row = table + i*num_targets;
+            for (unsigned long j = 0; j<num_targets; ++j)
+                row[j] = ws.get_distance(targets[j]);
+        }
     }
-    else
-    {
+}
+
 /*
-        for (unsigned long i = 1; i<=old_num_vertices; ++i) {
-            std::cout << h[i] << std::endl;
+ * Yen's k-shortest simple paths implementation
+ */
+
+/* spur path of Yen's algorithm: the shortest path from last[j] to 't' which
+ * avoids the root last[0..j-1] and the arcs leaving last[j] toward the next
+ * vertex of every accepted path sharing that root. The search stops beyond
+ * 'bound' (total weight); returns the total weight (DBL_MAX if there is no
+ * such path) and fills 'path' with the whole s->t path
+ */
+static double spur_path(AdjacencyList<> *graph, unsigned long t, const std::vector<unsigned long> &last,
+    unsigned long j, double root_weight, const std::vector<std::vector<unsigned long> > &accepted,
+    double bound, sssp_workspace *ws, std::vector<unsigned long> *path)
+{
+    unsigned long spur = last[j];
+
+    std::vector<unsigned long> blocked;
+    for (unsigned long i = 0; i<accepted.size(); ++i)
+    {
+        const std::vector<unsigned long> &p = accepted[i];
+        if (p.size() > j+1 && std::equal(p.begin(), p.begin() + j+1, last.begin()))
+            blocked.push_back(p[j+1]);
+    }
+
+    for (unsigned long i = 0; i<j; ++i)
+        ws->mark(last[i]);
+
+    ws->reset();
+    ws->add_source(spur);
+
+    double radius = bound - root_weight;
+    while (ws->has_next() && ws->next_key() <= radius)
+    {
+        unsigned long u = ws->settle_next();
+        if (u == t)
+            break;
+
+        double du = ws->get_distance(u);
+
+        Edge* adj = graph->get_vertex(u)->get_adjacencies();
+        while (adj)
+        {
+            unsigned long v = adj->get_successor()->get_key();
+            double d = du + adj->get_weight();
+
+            // root vertices and blocked arcs are out of the graph
+            if (!ws->is_marked(v) && d <= radius
+                && (u != spur || std::find(blocked.begin(), blocked.end(), v) == blocked.end()))
+                ws->relax(v, d, u);
+
+            adj = adj->get_next();   // next edge
         }
-        std::cout << std::endl;
-*/
-        // it's ok to remove 's' from the graph */
-        for (unsigned long i = 1; i <= old_num_vertices; ++i)
-            delete graph->removeEdge(s, i);
-        graph->removeIfIsolatedVertex(s);
+    }
+
+    for (unsigned long i = 0; i<j; ++i)
+        ws->unmark(last[i]);
+
+    if (!ws->is_settled(t))
+        return DBL_MAX;
+
+    std::vector<unsigned long> spur_part;
+    ws->get_path(t, &spur_part);
+
+    path->assign(last.begin(), last.begin() + j);
+    path->insert(path->end(), spur_part.begin(), spur_part.end());
+
+    return root_weight + ws->get_distance(t);
+}
+
+unsigned long k_shortest_paths(AdjacencyList<> *graph, unsigned long source, unsigned long target,
+    unsigned long k, std::vector<std::vector<unsigned long> > *paths, std::vector<double> *weights)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    graph->get_vertex(target);   // throws NoSuchVertexException
 
-        delete[] bf_paths;   // paths used by bellman-ford are unnecessary
+    paths->clear();
+    weights->clear();
 
-        // redefine each arc weight using 'h'
-        for (unsigned long u = 1; u<=old_num_vertices; ++u)
+    // first path: plain dijkstra
+    sssp_workspace first(num_vertices);
+    dijkstra_to_targets(graph, source, std::vector<unsigned long>(1, target), &first);
+    if (k == 0 || first.get_distance(target) == DBL_MAX)
+        return 0;
+
+    paths->resize(1);
+    first.get_path(target, &(*paths)[0]);
+    weights->push_back(first.get_distance(target));
+    if (k == 1)
+        return 1;
+
+    // openmp setup
+    if ( !magical_config::load_settings("yen", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    // candidates B, by weight (and path, which also drops duplicates)
+    std::set<std::pair<double, std::vector<unsigned long> > > candidates;
+    std::vector<double> root_weight;
+    std::vector<std::pair<double, std::vector<unsigned long> > > found;
+    double bound = DBL_MAX;
+    bool done = false;
+
+    #pragma omp parallel default(none) shared(graph, target, k, paths, weights, num_vertices, candidates, root_weight, found, bound, done)
+    {
+        // per-thread workspace, reused by every spur search
+        sssp_workspace ws(num_vertices);
+
+        while (!done)
         {
-            Edge* it = graph->get_vertex(u)->get_adjacencies();
-            while (it)
+            #pragma omp single
             {
-                // current adjacency information
-                unsigned long v = it->get_successor()->get_key();
-                double w = it->get_weight();
+                // root weights along the last accepted path (cheapest arcs)
+                const std::vector<unsigned long> &last = paths->back();
+                root_weight.assign(last.size(), 0);
+                for (unsigned long j = 1; j<last.size(); ++j)
+                {
+                    double cheapest = DBL_MAX;
+                    Edge* adj = graph->get_vertex(last[j-1])->get_adjacencies();
+                    for (; adj; adj = adj->get_next())
+                        if (adj->get_successor()->get_key() == last[j])
+                            cheapest = std::min(cheapest, adj->get_weight());
+                    root_weight[j] = root_weight[j-1] + cheapest;
+                }
+
+                /* bound: with enough candidates for the paths still missing,
+                 * no spur path weighing more than the last of them is needed
+                 */
+                unsigned long needed = k - paths->size();
+                bound = DBL_MAX;
+                if (needed > 0 && candidates.size() >= needed)
+                {
+                    std::set<std::pair<double, std::vector<unsigned long> > >::iterator it = candidates.begin();
+                    std::advance(it, needed-1);
+                    bound = it->first;
+                }
+
+                found.assign(last.size() - 1, std::make_pair(DBL_MAX, std::vector<unsigned long>()));
+            }
 
-                // new weight w' from arc (u,v): w + h[u] - h[v]
-                it->set_weight(w + h[u] - h[v]);
+            // spur searches, one per vertex of the last path but the target
+            #pragma omp for schedule(dynamic)
+            for (long j = 0; j < (signed) found.size(); ++j)
+            {
+                found[j].first = spur_path(graph, target, paths->back(), j, root_weight[j],
+                    *paths, bound, &ws, &found[j].second);
+            }
 
-                it = it->get_next();   // next edge
+            #pragma omp single
+            {
+                for (unsigned long j = 0; j<found.size(); ++j)
+                    if (found[j].first < DBL_MAX)
+                        candidates.insert(found[j]);
+
+                // keep only the candidates which may still be taken
+                unsigned long needed = k - paths->size();
+                while (candidates.size() > needed)
+                    candidates.erase(--candidates.end());
+
+                if (candidates.empty())
+                    done = true;
+                else
+                {
+                    paths->push_back(candidates.begin()->second);
+                    weights->push_back(candidates.begin()->first);
+                    candidates.erase(candidates.begin());
+                    done = (paths->size() == k);
+                }
             }
         }
+    }
+
+    return paths->size();
+}
+
+/*
+ * Bellman-Ford's implementation
+ */
 
-        /* computes shortest paths for each pair of vertices (all-pairs) by
-         * calling Dijkstra's algorithm from each vertex in the original graph
-         */
-        #pragma omp parallel for default(none) shared(graph, old_num_vertices, dist, paths, h) schedule(static)
-        for (long u = 1; u <= (signed) old_num_vertices; ++u)
+/* predecessor-graph check (Tarjan 1981): every cycle of the graph formed by
+ * the arcs (pred[v],v) has negative weight, so the walks up from the given
+ * vertices stop at a root, at a vertex walked from in an earlier walk, or on a
+ * cycle. 'stamp' (indexed 1..n, values only grow) marks the walks; returns a
+ * vertex on a cycle, or 0 if there is none
+ */
+static unsigned long predecessor_cycle(const std::vector<unsigned long> &from,
+    const unsigned long *pred, std::vector<unsigned long> &stamp, unsigned long &last_stamp)
+{
+    unsigned long first_walk = last_stamp + 1;
+
+    for (unsigned long i = 0; i<from.size(); ++i)
+    {
+        unsigned long walk = ++last_stamp;
+        unsigned long v = from[i];
+
+        while (v != 0 && stamp[v] < first_walk)
         {
-            double d[old_num_vertices+1];
-            std::vector<unsigned long> p[old_num_vertices+1];
+            stamp[v] = walk;
+            v = pred[v];
+        }
+
+        if (v != 0 && stamp[v] == walk)
+            return v;   // back to a vertex of this very walk
+    }
+
+    return 0;
+}
+
+/* frontier-based Bellman-Ford (as in SPFA): each round, only the vertices whose
+ * estimate changed in the previous one relax their arcs, in parallel. 'dist'
+ * and 'pred' (indexed 1..n) hold the initial estimates, and 'frontier' the
+ * vertices to start from. Returns false on negative-weight cycles, which are
+ * found early as cycles of the predecessor graph; then 'cycle' holds a vertex
+ * on one of them
+ */
+static bool frontier_bellman_ford(AdjacencyList<> *graph, std::vector<unsigned long> &frontier,
+    double *dist, unsigned long *pred, unsigned long *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+
+    // one lock per vertex keeps each estimate consistent with its predecessor
+    std::vector<omp_lock_t> locks(num_vertices+1);
+    for (unsigned long v = 1; v<=num_vertices; ++v)
+        omp_init_lock(&locks[v]);
+
+    std::vector<char> queued(num_vertices+1, 0);   // already in the next frontier
+    std::vector<unsigned long> stamp(num_vertices+1, 0);
+    unsigned long last_stamp = 0;
 
-//            double *d = new double[old_num_vertices+1];
-//            std::vector<unsigned long> *p = new std::vector<unsigned long>[old_num_vertices+1];
+    int num_threads = omp_get_max_threads();
+    std::vector<std::vector<unsigned long> > next(num_threads);
+    std::vector<unsigned long> scanned(num_threads, 0);
 
-            dijkstra(graph, u, d, p);
+    /* a predecessor check costs O(n), so it runs once the arcs scanned since
+     * the previous one reach n, keeping its share of the total work bounded
+     */
+    unsigned long unchecked = 0;
+    *cycle = 0;
+
+    /* n-1 rounds settle every shortest path (n for the implicit super-source
+     * of johnson's potentials); any later change comes from a negative cycle
+     */
+    for (unsigned long round = 1; !frontier.empty(); ++round)
+    {
+        if (round > num_vertices)
+        {
+            *cycle = predecessor_cycle(frontier, pred, stamp, last_stamp);
+            if (*cycle == 0)
+            {
+                /* n steps up the predecessors of a vertex changed in round n
+                 * land on a cycle
+                 */
+                unsigned long v = frontier[0];
+                for (unsigned long i = 0; i<num_vertices && pred[v] != 0; ++i)
+                    v = pred[v];
+                *cycle = v;
+            }
+            break;
+        }
 
-//            delete[] d;
-//            delete[] p;
+        long size = frontier.size();
 
-//            std::cout << "thread #" << omp_get_thread_num() << " (core #" //<< sched_getcpu()
-//                << ") finished dijkstra execution from vertex #" << u << std::endl << std::flush;
+        #pragma omp parallel default(none) shared(graph, frontier, size, dist, pred, locks, queued, next, scanned)
+        {
+            int thr = omp_get_thread_num();
+            std::vector<unsigned long> &local = next[thr];
+            local.clear();
+
+            #pragma omp for schedule(static)
+            for (long i = 0; i<size; ++i)
+                queued[frontier[i]] = 0;
 
-            // real path weight, using arc (u,v): w = w - h[u] + h[v]
-            for (unsigned long v = 1; v<=old_num_vertices; ++v)
+            #pragma omp for schedule(dynamic, 64)
+            for (long i = 0; i<size; ++i)
             {
-                dist[u][v] = d[v] - h[u] + h[v];
-                paths[u][v].assign( p[v].begin(), p[v].end() );
+                unsigned long u = frontier[i];
+                double du = dist[u];
+
+                Edge* it = graph->get_vertex(u)->get_adjacencies();
+                while (it)
+                {
+                    unsigned long v = it->get_successor()->get_key();
+                    double d = du + it->get_weight();
+                    ++scanned[thr];
+
+                    // relax arc(u,v): cheap unlocked test first
+                    if (d < dist[v])
+                    {
+                        omp_set_lock(&locks[v]);
+                        if (d < dist[v])
+                        {
+                            dist[v] = d;
+                            pred[v] = u;
+
+                            if (!queued[v])
+                            {
+                                queued[v] = 1;
+                                local.push_back(v);
+                            }
+                        }
+                        omp_unset_lock(&locks[v]);
+                    }
+
+                    it = it->get_next();   // next edge
+                }
             }
+        }
 
-            //#pragma omp critical
-            //std::cout << paths[u][1][0] << std::endl;
+        // next frontier: vertices changed in this round
+        frontier.clear();
+        for (int t = 0; t<num_threads; ++t)
+        {
+            frontier.insert(frontier.end(), next[t].begin(), next[t].end());
+            unchecked += scanned[t];
+            scanned[t] = 0;
         }
 
-        // RESTORE original weight from arc (u,v): w = w - h[u] + h[v]
-        for (unsigned long u = 1; u<=old_num_vertices; ++u)
+        if (!frontier.empty() && unchecked >= num_vertices)
         {
-            Edge* it = graph->get_vertex(u)->get_adjacencies();
-            while (it)
-            {
-                // current adjacency information
-                unsigned long v = it->get_successor()->get_key();
-                double w = it->get_weight();
+            unchecked = 0;
+            *cycle = predecessor_cycle(frontier, pred, stamp, last_stamp);
+            if (*cycle != 0)
+                break;
+        }
+    }
 
-                // new weight w' from arc (u,v): w - h[u] + h[v]
-                it->set_weight(w - h[u] + h[v]);
+    for (unsigned long v = 1; v<=num_vertices; ++v)
+        omp_destroy_lock(&locks[v]);
 
-                it = it->get_next();   // next edge
-            }
+    return *cycle == 0;
+}
+
+/* follows the predecessors from 'v' (on a cycle of the predecessor graph)
+ * back to it, storing the cycle in arc order; its weight takes the cheapest
+ * arc between consecutive vertices, as relaxations do
+ */
+static void extract_cycle(AdjacencyList<> *graph, const unsigned long *pred, unsigned long v, negative_cycle *cycle)
+{
+    cycle->vertices.clear();
+    cycle->weight = 0;
+
+    unsigned long x = v;
+    do
+    {
+        cycle->vertices.push_back(x);
+        x = pred[x];
+    }
+    while (x != v && x != 0 && cycle->vertices.size() <= graph->get_vertex_count());
+
+    if (x != v)
+    {
+        cycle->vertices.clear();   // should not happen: v is not on a cycle
+        return;
+    }
+
+    std::reverse(cycle->vertices.begin(), cycle->vertices.end());
+
+    for (unsigned long i = 0; i<cycle->vertices.size(); ++i)
+    {
+        unsigned long from = cycle->vertices[i];
+        unsigned long to = cycle->vertices[(i+1) % cycle->vertices.size()];
+
+        double cheapest = DBL_MAX;
+        Edge* it = graph->get_vertex(from)->get_adjacencies();
+        while (it)
+        {
+            if (it->get_successor()->get_key() == to)
+                cheapest = std::min(cheapest, it->get_weight());
+            it = it->get_next();   // next edge
         }
 
-        delete[] h;
+        cycle->weight += cheapest;
+    }
+}
+
+bool bellman_ford(AdjacencyList<> *graph, unsigned long source, double dist[], unsigned long pred[], negative_cycle *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    graph->get_vertex(source);   // throws NoSuchVertexException
+
+    // openmp setup
+    if ( !magical_config::load_settings("bellman_ford", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    // initialize_single_source: shortest path estimate and predecessor of each vertex
+    for (unsigned long i = 1; i<=num_vertices; ++i)
+    {
+        dist[i] = DBL_MAX;
+        pred[i] = 0;
+    }
+    dist[source] = 0;
+
+    std::vector<unsigned long> frontier(1, source);
+    unsigned long on_cycle;
 
+    if (frontier_bellman_ford(graph, frontier, dist, pred, &on_cycle))
         return true;
+
+    if (cycle)
+        extract_cycle(graph, pred, on_cycle, cycle);
+    return false;
+}
+
+bool bellman_ford(AdjacencyList<> *graph, unsigned long source, double dist[], std::vector<unsigned long> paths[], negative_cycle *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    std::vector<unsigned long> pred(num_vertices+1, 0);
+
+    bool no_cycle = bellman_ford(graph, source, dist, &pred[0], cycle);
+
+    // paths: walk back the predecessors (only meaningful without negative cycles)
+    for (unsigned long v = 1; v<=num_vertices; ++v)
+    {
+        paths[v].clear();
+        if (!no_cycle || dist[v] == DBL_MAX)
+            continue;
+
+        for (unsigned long x = v; x != source; x = pred[x])
+            paths[v].push_back(x);
+        paths[v].push_back(source);
+        std::reverse(paths[v].begin(), paths[v].end());
     }
 
+    return no_cycle;
 }
+
+
+/*
+ * File sink implementation
+ */
+
+apsp_file_sink::apsp_file_sink(const char *filename, unsigned long n)
+{
+    num_vertices = n;
+    failed = false;
+
+    fh = fopen(filename, "wb");
+    if (!fh)
+    {
+        std::cerr << "[magical] could not open file " << filename << std::endl;
+        failed = true;
+    }
+}
+
+apsp_file_sink::~apsp_file_sink()
+{
+    if (fh)
+        fclose(fh);
+}
+
+bool apsp_file_sink::good() const { return !failed; }
+
+void apsp_file_sink::store_row(unsigned long u, const double *d, const unsigned long*)
+{
+    // rows arrive in any order: each one goes to its own offset
+    #pragma omp critical(apsp_file_sink)
+    {
+        if (!failed)
+        {
+            long offset = (long) (u-1) * num_vertices * sizeof(double);
+            failed = fseek(fh, offset, SEEK_SET) != 0
+                || fwrite(d + 1, sizeof(double), num_vertices, fh) != num_vertices;
+        }
+    }
+}
+
+/*
+ * Johnson's implementation
+ */
+
+/* caller-allocated n x n arrays, with one path vector per pair */
+class path_array_sink : public apsp_row_sink
+{
+public:
+    path_array_sink(double **d, std::vector<unsigned long> **p, unsigned long n)
+    {
+        dist = d;
+        paths = p;
+        num_vertices = n;
+    }
+
+    void store_row(unsigned long u, const double *d, const unsigned long *pred)
+    {
+        for (unsigned long v = 1; v<=num_vertices; ++v)
+        {
+            dist[u][v] = d[v];
+
+            // path: walk back the predecessors from v
+            std::vector<unsigned long> &path = paths[u][v];
+            path.clear();
+            if (d[v] < DBL_MAX)
+            {
+                for (unsigned long x = v; x != u; x = pred[x])
+                    path.push_back(x);
+                path.push_back(u);
+                std::reverse(path.begin(), path.end());
+            }
+        }
+    }
+
+private:
+    double **dist;
+    std::vector<unsigned long> **paths;
+    unsigned long num_vertices;
+};
+
+template <class D>
+class all_pairs_sink : public apsp_row_sink
+{
+public:
+    all_pairs_sink(AllPairsResult<D> *r) { result = r; }
+
+    void store_row(unsigned long u, const double *d, const unsigned long *pred)
+    {
+        result->set_row(u, d, pred);
+    }
+
+private:
+    AllPairsResult<D> *result;
+};
+
+/* whether AllPairsResult<D> holds the distances of the graph: unsigned types
+ * hold no negative ones, which any negative arc gives
+ */
+template <class D>
+static bool distances_fit(AdjacencyList<> *graph, const char *algorithm)
+{
+    if (std::numeric_limits<D>::is_signed || analyze_graph(graph).nonnegative)
+        return true;
+
+    std::cerr << "[magical] graph given to " << algorithm << " has negative weights, "
+        << "which unsigned distances cannot hold." << std::endl;
+    return false;
+}
+
+/* adds 'count' distances to 'bin' of a histogram whose first entry is bin
+ * 'first', growing it on either side
+ */
+static void add_to_histogram(std::vector<unsigned long> &bins, long &first, long bin, unsigned long count)
+{
+    if (bins.empty())
+        first = bin;
+
+    if (bin < first)
+    {
+        bins.insert(bins.begin(), first - bin, 0);
+        first = bin;
+    }
+    if (bin - first >= (long) bins.size())
+        bins.resize(bin - first + 1, 0);
+
+    bins[bin - first] += count;
+}
+
+/* reduces each row into per-vertex totals (rows of distinct sources never
+ * collide) and a histogram, merged under a critical section once per row
+ */
+class statistics_sink : public apsp_row_sink
+{
+public:
+    statistics_sink(apsp_statistics *s, unsigned long n)
+    : row_sum(n+1, 0), row_count(n+1, 0)
+    {
+        stats = s;
+        num_vertices = n;
+    }
+
+    void store_row(unsigned long u, const double *d, const unsigned long*)
+    {
+        double sum = 0, eccentricity = 0;
+        unsigned long count = 0;
+        std::vector<unsigned long> bins;
+        long first = 0;
+
+        for (unsigned long v = 1; v<=num_vertices; ++v)
+        {
+            if (v == u || d[v] == DBL_MAX)
+                continue;
+
+            eccentricity = (count == 0) ? d[v] : std::max(eccentricity, d[v]);
+            sum += d[v];
+            ++count;
+
+            if (stats->histogram_width > 0)
+                add_to_histogram(bins, first, (long) floor(d[v] / stats->histogram_width), 1);
+        }
+
+        stats->eccentricity[u] = eccentricity;
+        row_sum[u] = sum;
+        row_count[u] = count;
+
+        if (!bins.empty())
+        {
+            #pragma omp critical(statistics_sink)
+            for (unsigned long i = 0; i<bins.size(); ++i)
+            {
+                if (bins[i] > 0)
+                    add_to_histogram(stats->histogram, stats->histogram_first, first + (long) i, bins[i]);
+            }
+        }
+    }
+
+    // graph-wide values from the per-vertex totals
+    void finish()
+    {
+        double total = 0;
+        bool any = false;
+
+        for (unsigned long u = 1; u<=num_vertices; ++u)
+        {
+            double sum = row_sum[u];
+            unsigned long count = row_count[u];
+
+            stats->closeness[u] = (count > 0 && sum > 0)
+                ? (double) count * count / ((num_vertices - 1) * sum) : 0;
+
+            if (count > 0)
+            {
+                stats->diameter = any ? std::max(stats->diameter, stats->eccentricity[u]) : stats->eccentricity[u];
+                any = true;
+            }
+
+            total += sum;
+            stats->reachable_pairs += count;
+        }
+
+        stats->average = (stats->reachable_pairs > 0) ? total / stats->reachable_pairs : 0;
+    }
+
+private:
+    apsp_statistics *stats;
+    unsigned long num_vertices;
+    std::vector<double> row_sum;
+    std::vector<unsigned long> row_count;
+};
+
+/* potentials for johnson's reweighting: distances from an implicit
+ * super-source joined to every vertex by 0-weight arcs, i.e. Bellman-Ford with
+ * every estimate starting at 0 and every vertex in the first frontier. Returns
+ * false on negative-weight cycles, stored in 'cycle' (if not 0)
+ */
+static bool johnson_potentials(AdjacencyList<> *graph, double *h, negative_cycle *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    std::vector<unsigned long> pred(num_vertices+1, 0);
+    std::vector<unsigned long> frontier(num_vertices);
+
+    for (unsigned long v = 1; v<=num_vertices; ++v)
+    {
+        h[v] = 0;
+        frontier[v-1] = v;
+    }
+
+    unsigned long on_cycle;
+
+    if (frontier_bellman_ford(graph, frontier, h, &pred[0], &on_cycle))
+        return true;
+
+    if (cycle)
+        extract_cycle(graph, &pred[0], on_cycle, cycle);
+    return false;
+}
+
+/* johnson's kernel: computes potentials 'h', then runs dijkstra from every
+ * vertex on the reduced costs w(u,v) + h[u] - h[v], handing each row (with
+ * original weights) to the sink. Graphs without negative weights (or cycles)
+ * skip the potentials and use the kernels of shortest_paths() instead. The
+ * graph is only read, so concurrent runs (and other algorithms) may share it
+ */
+static bool johnson_kernel(AdjacencyList<> *graph, apsp_row_sink *sink, parallel_profile *profile, negative_cycle *cycle)
+{
+    // before the settings below, as the analysis loads its own
+    const graph_properties &properties = analyze_graph(graph);
+
+    // openmp setup
+    if ( !magical_config::load_settings("johnson", graph->get_vertex_count()) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+        
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    /* per-source cost varies with reachability and degrees, so sources are
+     * handed out dynamically by default (schedule(runtime) below)
+     */
+    magical_config::load_schedule("johnson");
+    
+    /* "producing nonnegative weights (while preserving shortest paths) by
+     * reweighting" (see Cormen et al. 2001): let h[i] be the weight of the
+     * shortest path between an artificial vertex 's' (with 0-weight arcs to
+     * every vertex) and 'i'
+     */
+    unsigned long num_vertices = graph->get_vertex_count();
+    std::vector<double> h(num_vertices+1, 0);
+
+    /* nonnegative weights need no reweighting, nor do acyclic graphs (relaxed
+     * in topological order): each source then goes to the cheapest kernel
+     */
+    bool reweight = !properties.nonnegative && !properties.acyclic;
+
+    if (reweight && !johnson_potentials(graph, &h[0], cycle))
+        return false;   // negative-weight cycle detected
+
+    // dense graphs: one weight matrix (of reduced costs) shared by every thread
+    dense_dijkstra *dense = 0;
+    if ((reweight || properties.nonnegative) && prefer_dense_dijkstra(graph))
+        dense = new dense_dijkstra(graph, reweight ? &h[0] : 0);
+
+    int num_threads = omp_get_max_threads();
+    std::vector<double> busy_time(num_threads, 0);
+    std::vector<unsigned long> iterations(num_threads, 0);
+    double start = omp_get_wtime();
+
+    /* computes shortest paths for each pair of vertices (all-pairs) by
+     * calling Dijkstra's algorithm from each vertex in the original graph
+     */
+    #pragma omp parallel default(none) shared(graph, num_vertices, sink, h, reweight, dense, busy_time, iterations)
+    {
+        // per-thread workspace and row buffers
+        sssp_workspace ws(num_vertices);
+        std::vector<double> d(num_vertices+1, DBL_MAX);
+        std::vector<unsigned long> p(num_vertices+1, 0);
+        int thr = omp_get_thread_num();
+
+        #pragma omp for schedule(runtime)
+        for (long u = 1; u <= (signed) num_vertices; ++u)
+        {
+            double source_start = omp_get_wtime();
+            if (dense)
+                dense->run(u, &ws);
+            else if (reweight)
+                dijkstra(graph, u, &ws, &h[0]);
+            else
+                shortest_paths(graph, u, &ws);
+
+            // real path weight, using arc (u,v): w = w' - h[u] + h[v]
+            for (unsigned long v = 1; v<=num_vertices; ++v)
+            {
+                double dv = ws.get_distance(v);
+                d[v] = (dv == DBL_MAX) ? DBL_MAX : dv - h[u] + h[v];
+                p[v] = ws.get_predecessor(v);
+            }
+
+            sink->store_row(u, &d[0], &p[0]);
+
+            busy_time[thr] += omp_get_wtime() - source_start;
+            ++iterations[thr];
+        }
+    }
+
+    delete dense;
+
+    if (profile)
+    {
+        profile->wall_time = omp_get_wtime() - start;
+        profile->busy_time = busy_time;
+        profile->iterations = iterations;
+    }
+
+    return true;
+}
+
+bool johnson(AdjacencyList<> *graph, double **dist, std::vector<unsigned long> **paths, negative_cycle *cycle)
+{
+    path_array_sink sink(dist, paths, graph->get_vertex_count());
+    return johnson_kernel(graph, &sink, 0, cycle);
+}
+
+bool johnson(AdjacencyList<> *graph, apsp_row_sink *sink, parallel_profile *profile, negative_cycle *cycle)
+{
+    return johnson_kernel(graph, sink, profile, cycle);
+}
+
+bool all_pairs_statistics(AdjacencyList<> *graph, apsp_statistics *stats, double histogram_width, negative_cycle *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+
+    stats->diameter = stats->average = 0;
+    stats->reachable_pairs = 0;
+    stats->eccentricity.assign(num_vertices+1, 0);
+    stats->closeness.assign(num_vertices+1, 0);
+    stats->histogram_width = histogram_width;
+    stats->histogram_first = 0;
+    stats->histogram.clear();
+
+    statistics_sink sink(stats, num_vertices);
+    if (batched_weights(graph))
+    {
+        std::vector<unsigned long> sources(num_vertices);
+        for (unsigned long v = 1; v<=num_vertices; ++v)
+            sources[v-1] = v;
+
+        batched_distances(graph, sources, &sink);
+    }
+    else if (!johnson_kernel(graph, &sink, 0, cycle))
+        return false;
+
+    sink.finish();
+    return true;
+}
+
+template <class D>
+bool johnson(AdjacencyList<> *graph, AllPairsResult<D> *result, parallel_profile *profile, negative_cycle *cycle)
+{
+    if (result->get_vertex_count() != graph->get_vertex_count())
+    {
+        std::cerr << "[magical] result given to johnson's algorithm does not match the graph size." << std::endl;
+        return false;
+    }
+
+    if (!distances_fit<D>(graph, "johnson's algorithm"))
+        return false;
+
+    all_pairs_sink<D> sink(result);
+    return johnson_kernel(graph, &sink, profile, cycle);
+}
+
+// distance types supported by AllPairsResult
+template bool johnson<double>(AdjacencyList<>*, AllPairsResult<double>*, parallel_profile*, negative_cycle*);
+template bool johnson<float>(AdjacencyList<>*, AllPairsResult<float>*, parallel_profile*, negative_cycle*);
+template bool johnson<unsigned int>(AdjacencyList<>*, AllPairsResult<unsigned int>*, parallel_profile*, negative_cycle*);
+
+
+/*
+ * Floyd-Warshall's implementation
+ */
+
+/* min-plus update of the tile rows [i0,i1) x columns [j0,j1) through the
+ * intermediate vertices [k0,k1): d[i][j] = min(d[i][j], d[i][k] + d[k][j]),
+ * taking the predecessor of j from row k on improvement. Matrices are
+ * row-major with 'stride' entries per row, indexed by vertex key
+ */
+static void min_plus_tile(double *dist, unsigned long *pred, unsigned long stride,
+    unsigned long i0, unsigned long i1, unsigned long j0, unsigned long j1,
+    unsigned long k0, unsigned long k1)
+{
+    for (unsigned long k = k0; k<k1; ++k)
+    {
+        const double *dk = dist + k*stride;
+        const unsigned long *pk = pred + k*stride;
+
+        for (unsigned long i = i0; i<i1; ++i)
+        {
+            double *di = dist + i*stride;
+            unsigned long *pi = pred + i*stride;
+            double dik = di[k];
+
+            if (dik == HUGE_VAL)
+                continue;   // i does not reach k: no path through it
+
+            unsigned long j = j0;
+#if defined(__AVX2__) && __SIZEOF_LONG__ == 8
+            // four columns at a time; predecessors blend as 64-bit lanes
+            __m256d vik = _mm256_set1_pd(dik);
+            for (; j+4 <= j1; j += 4)
+            {
+                __m256d d = _mm256_add_pd(vik, _mm256_loadu_pd(dk + j));
+                __m256d dij = _mm256_loadu_pd(di + j);
+                __m256d less = _mm256_cmp_pd(d, dij, _CMP_LT_OQ);
+                _mm256_storeu_pd(di + j, _mm256_blendv_pd(dij, d, less));
+
+                __m256d pkj = _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i*) (pk + j)));
+                __m256d pij = _mm256_castsi256_pd(_mm256_loadu_si256((const __m256i*) (pi + j)));
+                _mm256_storeu_si256((__m256i*) (pi + j), _mm256_castpd_si256(_mm256_blendv_pd(pij, pkj, less)));
+            }
+#endif
+            for (; j<j1; ++j)
+            {
+                double d = dik + dk[j];
+                if (d < di[j])
+                {
+                    di[j] = d;
+                    pi[j] = pk[j];
+                }
+            }
+        }
+    }
+}
+
+/* blocked Floyd-Warshall (Venkataraman et al. 2003): for each diagonal tile,
+ * the tile itself, then the tiles sharing its rows or columns, then all the
+ * others, the last two phases in parallel. Rows are handed to the sink as
+ * johnson_kernel does; returns false on negative-weight cycles
+ */
+static bool floyd_warshall_kernel(AdjacencyList<> *graph, apsp_row_sink *sink, parallel_profile *profile, negative_cycle *cycle)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+
+    // openmp setup
+    if ( !magical_config::load_settings("floyd_warshall", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    // tile side: a pair of tiles should fit in the L1/L2 caches
+    unsigned long block = atol(magical_config::get_setting("floyd_warshall", "block").c_str());
+    if (block == 0)
+        block = 64;
+
+    // column 0 is unused, so each row is indexed by vertex key (as sinks expect)
+    unsigned long stride = num_vertices + 1;
+    std::vector<double> dist((size_t) stride * stride, HUGE_VAL);
+    std::vector<unsigned long> pred((size_t) stride * stride, 0);
+
+    #pragma omp parallel for default(none) shared(graph, num_vertices, stride, dist, pred) schedule(static)
+    for (long u = 1; u <= (signed) num_vertices; ++u)
+    {
+        double *du = &dist[u*stride];
+        unsigned long *pu = &pred[u*stride];
+        du[u] = 0;
+
+        // cheapest arc between each pair (negative self-loops are cycles)
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            unsigned long v = it->get_successor()->get_key();
+            if (it->get_weight() < du[v])
+            {
+                du[v] = it->get_weight();
+                pu[v] = (v == (unsigned long) u) ? 0 : u;
+            }
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    long num_blocks = (num_vertices + block - 1) / block;
+    int num_threads = omp_get_max_threads();
+    std::vector<double> busy_time(num_threads, 0);
+    std::vector<unsigned long> iterations(num_threads, 0);
+    bool negative = false;
+    double start = omp_get_wtime();
+
+    #pragma omp parallel default(none) shared(num_vertices, block, num_blocks, stride, dist, pred, busy_time, iterations, negative)
+    {
+        int thr = omp_get_thread_num();
+        double *d = &dist[0];
+        unsigned long *p = &pred[0];
+
+        for (long kb = 0; kb<num_blocks; ++kb)
+        {
+            unsigned long k0 = 1 + kb*block;
+            unsigned long k1 = std::min(k0 + block, num_vertices + 1);
+
+            // phase 1: diagonal tile, after checking the previous rounds
+            #pragma omp single
+            {
+                for (unsigned long v = 1; v<=num_vertices && !negative; ++v)
+                    negative = dist[v*stride + v] < 0;
+
+                if (!negative)
+                    min_plus_tile(d, p, stride, k0, k1, k0, k1, k0, k1);
+            }
+
+            if (negative)
+                break;   // every thread sees the flag after the barrier
+
+            // phase 2: tiles in the rows (even t) or columns (odd t) of the diagonal one
+            #pragma omp for schedule(dynamic)
+            for (long t = 0; t < 2*num_blocks; ++t)
+            {
+                long b = t / 2;
+                if (b == kb)
+                    continue;
+
+                double tile_start = omp_get_wtime();
+                unsigned long b0 = 1 + b*block;
+                unsigned long b1 = std::min(b0 + block, num_vertices + 1);
+
+                if (t % 2 == 0)
+                    min_plus_tile(d, p, stride, k0, k1, b0, b1, k0, k1);
+                else
+                    min_plus_tile(d, p, stride, b0, b1, k0, k1, k0, k1);
+
+                busy_time[thr] += omp_get_wtime() - tile_start;
+                ++iterations[thr];
+            }
+
+            // phase 3: every other tile, through the rows and columns above
+            #pragma omp for schedule(dynamic)
+            for (long t = 0; t < num_blocks*num_blocks; ++t)
+            {
+                long ib = t / num_blocks;
+                long jb = t % num_blocks;
+                if (ib == kb || jb == kb)
+                    continue;
+
+                double tile_start = omp_get_wtime();
+                unsigned long i0 = 1 + ib*block;
+                unsigned long j0 = 1 + jb*block;
+
+                min_plus_tile(d, p, stride,
+                    i0, std::min(i0 + block, num_vertices + 1),
+                    j0, std::min(j0 + block, num_vertices + 1), k0, k1);
+
+                busy_time[thr] += omp_get_wtime() - tile_start;
+                ++iterations[thr];
+            }
+        }
+    }
+
+    for (unsigned long v = 1; v<=num_vertices && !negative; ++v)
+        negative = dist[v*stride + v] < 0;
+
+    if (negative)
+    {
+        // the matrix holds no usable cycle: find one as johnson would
+        if (cycle)
+        {
+            std::vector<double> h(num_vertices+1, 0);
+            johnson_potentials(graph, &h[0], cycle);
+        }
+        return false;
+    }
+
+    #pragma omp parallel for default(none) shared(num_vertices, stride, dist, pred, sink) schedule(static)
+    for (long u = 1; u <= (signed) num_vertices; ++u)
+    {
+        double *du = &dist[u*stride];
+        for (unsigned long v = 1; v<=num_vertices; ++v)
+        {
+            if (du[v] == HUGE_VAL)
+                du[v] = DBL_MAX;   // unreachable, as sinks expect
+        }
+
+        sink->store_row(u, du, &pred[u*stride]);
+    }
+
+    if (profile)
+    {
+        profile->wall_time = omp_get_wtime() - start;
+        profile->busy_time = busy_time;
+        profile->iterations = iterations;
+    }
+
+    return true;
+}
+
+bool floyd_warshall(AdjacencyList<> *graph, double **dist, std::vector<unsigned long> **paths, negative_cycle *cycle)
+{
+    path_array_sink sink(dist, paths, graph->get_vertex_count());
+    return floyd_warshall_kernel(graph, &sink, 0, cycle);
+}
+
+bool floyd_warshall(AdjacencyList<> *graph, apsp_row_sink *sink, parallel_profile *profile, negative_cycle *cycle)
+{
+    return floyd_warshall_kernel(graph, sink, profile, cycle);
+}
+
+template <class D>
+bool floyd_warshall(AdjacencyList<> *graph, AllPairsResult<D> *result, parallel_profile *profile, negative_cycle *cycle)
+{
+    if (result->get_vertex_count() != graph->get_vertex_count())
+    {
+        std::cerr << "[magical] result given to floyd-warshall's algorithm does not match the graph size." << std::endl;
+        return false;
+    }
+
+    if (!distances_fit<D>(graph, "floyd-warshall's algorithm"))
+        return false;
+
+    all_pairs_sink<D> sink(result);
+    return floyd_warshall_kernel(graph, &sink, profile, cycle);
+}
+
+/* dense inputs favor floyd-warshall: its n^3 min-plus steps run on contiguous
+ * (vectorized) rows, while johnson's n searches follow every arc through the
+ * adjacency lists. Thresholds come from magical_config
+ */
+static bool prefer_floyd_warshall(AdjacencyList<> *graph)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    if (num_vertices < 2)
+        return false;
+
+    // the n x n working matrices must be affordable
+    std::string max_size = magical_config::get_setting("floyd_warshall", "max_size");
+    unsigned long limit = max_size.empty() ? 4000 : atol(max_size.c_str());
+    if (num_vertices > limit)
+        return false;
+
+    std::string min_density = magical_config::get_setting("floyd_warshall", "min_density");
+    double threshold = min_density.empty() ? 0.1 : atof(min_density.c_str());
+
+    unsigned long num_arcs = 0;
+    for (unsigned long v = 1; v<=num_vertices; ++v)
+        num_arcs += graph->get_vertex(v)->get_outdegree();
+
+    return num_arcs >= threshold * num_vertices * (num_vertices - 1);
+}
+
+template <class D>
+bool all_pairs_shortest_paths(AdjacencyList<> *graph, AllPairsResult<D> *result, parallel_profile *profile, negative_cycle *cycle)
+{
+    if (prefer_floyd_warshall(graph))
+        return floyd_warshall(graph, result, profile, cycle);
+
+    return johnson(graph, result, profile, cycle);
+}
+
+template bool floyd_warshall<double>(AdjacencyList<>*, AllPairsResult<double>*, parallel_profile*, negative_cycle*);
+template bool floyd_warshall<float>(AdjacencyList<>*, AllPairsResult<float>*, parallel_profile*, negative_cycle*);
+template bool floyd_warshall<unsigned int>(AdjacencyList<>*, AllPairsResult<unsigned int>*, parallel_profile*, negative_cycle*);
+
+template bool all_pairs_shortest_paths<double>(AdjacencyList<>*, AllPairsResult<double>*, parallel_profile*, negative_cycle*);
+template bool all_pairs_shortest_paths<float>(AdjacencyList<>*, AllPairsResult<float>*, parallel_profile*, negative_cycle*);
+template bool all_pairs_shortest_paths<unsigned int>(AdjacencyList<>*, AllPairsResult<unsigned int>*, parallel_profile*, negative_cycle*);
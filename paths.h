@@ -2,15 +2,174 @@
 #define __PATHS_H__
 
 #include <vector>
+#include <cstdio>
 #include "types.h"
+#include "sssp_workspace.h"
+#include "all_pairs.h"
+#include "bfs.h"
 
-/* Dijkstra's single-source shortest path algorithm */
+/* load balance of a parallel run: busy time (seconds spent on iterations) and
+ * iterations handled by each thread, and the wall time of the parallel loop
+ */
+typedef struct {
+    std::vector<double> busy_time;
+    std::vector<unsigned long> iterations;
+    double wall_time;
+} parallel_profile;
+
+/* negative-weight cycle found by bellman_ford() or johnson(): its vertices in
+ * arc order (closing from the last one back to the first) and total weight
+ */
+typedef struct {
+    std::vector<unsigned long> vertices;
+    double weight;
+} negative_cycle;
+
+/* graph-wide statistics of the all-pairs distances, over ordered pairs (u,v)
+ * with u != v joined by a path; per-vertex values are indexed 1..n. Distance
+ * d falls in histogram bin floor(d / histogram_width) - histogram_first
+ */
+typedef struct {
+    double diameter;                    // largest distance (0 if no pair is joined)
+    double average;                     // average distance (0 if no pair is joined)
+    unsigned long reachable_pairs;
+    std::vector<double> eccentricity;   // largest distance from each vertex
+    std::vector<double> closeness;      // (r-1)^2 / ((n-1) * total distance), r vertices reached
+    double histogram_width;
+    long histogram_first;
+    std::vector<unsigned long> histogram;
+} apsp_statistics;
+
+/* receives each row of the all-pairs results: distances (DBL_MAX if
+ * unreachable) and predecessors of every vertex, both indexed 1..n. Rows of
+ * distinct sources are stored concurrently (in any order), and the buffers
+ * are reused once store_row() returns
+ */
+class apsp_row_sink
+{
+public:
+    virtual ~apsp_row_sink() { }
+    virtual void store_row(unsigned long, const double*, const unsigned long*) = 0;
+};
+
+/* row sink writing the distance matrix to a binary file: n x n doubles,
+ * row-major, no header (written by fwrite, hence not portable across
+ * architectures). good() tells whether every write succeeded
+ */
+class apsp_file_sink : public apsp_row_sink
+{
+public:
+    apsp_file_sink(const char*, unsigned long);
+    ~apsp_file_sink();
+
+    bool good() const;
+    void store_row(unsigned long, const double*, const unsigned long*);
+
+private:
+    FILE *fh;
+    unsigned long num_vertices;
+    bool failed;
+};
+
+/* Dijkstra's single-source shortest path algorithm; graphs whose arcs all
+ * weigh the same go to the direction-optimizing parallel_bfs instead
+ */
 void dijkstra(AdjacencyList<>*, unsigned long, double*, std::vector<unsigned long>*);
 
-/* Bellman-Ford's single-source shortest path algorithm */
-bool bellman_ford(AdjacencyList<>*, unsigned long, double*, std::vector<unsigned long>*);
+/* the same, searching uniform graphs with the given parallel_bfs (built on
+ * the graph), so that a loop over sources gathers its in-arcs only once
+ */
+void dijkstra(AdjacencyList<>*, unsigned long, double*, std::vector<unsigned long>*, parallel_bfs*);
+
+/* Dijkstra's algorithm leaving results (distances and predecessors) in the
+ * workspace, which is cheaper than building every path. As long as the arcs
+ * it meets weigh the same, vertices are settled breadth-first without the heap
+ */
+void dijkstra(AdjacencyList<>*, unsigned long, sssp_workspace*);
+
+/* same, on reduced costs w(u,v) + h[u] - h[v] for potentials 'h' (indexed 1..n)
+ * making every reduced cost nonnegative, as in Johnson's algorithm; the
+ * workspace then holds reduced distances d(s,v) + h[s] - h[v]
+ */
+void dijkstra(AdjacencyList<>*, unsigned long, sssp_workspace*, const double*);
+
+/* bounded variants of Dijkstra's algorithm, which stop as soon as every target
+ * is settled, the next vertex lies farther than the given radius, or the given
+ * number of vertices (source excluded) is settled, respectively. Results are
+ * left in the workspace (reset by each call); return the number of settled
+ * vertices
+ */
+unsigned long dijkstra_to_targets(AdjacencyList<>*, unsigned long, const std::vector<unsigned long>&, sssp_workspace*);
+unsigned long dijkstra_within_radius(AdjacencyList<>*, unsigned long, double, sssp_workspace*);
+unsigned long dijkstra_k_nearest(AdjacencyList<>*, unsigned long, unsigned long, sssp_workspace*);
+
+/* many-to-many distance table: fills the row-major |S|x|T| matrix with
+ * table[i*|T| + j] = d(sources[i], targets[j]) (DBL_MAX if unreachable), running
+ * in parallel one search per source which stops once every target is settled.
+ * Many sources on small integer weights go to batched_distances() instead
+ */
+void many_to_many(AdjacencyList<>*, const std::vector<unsigned long>&, const std::vector<unsigned long>&, double*);
+
+/* Yen's k shortest simple paths from s to t: fills up to k paths (both ends
+ * included) in increasing weight, with their weights, and returns how many
+ * exist. The spur searches of each round run in parallel, skipping what lies
+ * beyond the weight of the k-th best candidate so far (weights must be
+ * nonnegative)
+ */
+unsigned long k_shortest_paths(AdjacencyList<>*, unsigned long, unsigned long, unsigned long,
+    std::vector<std::vector<unsigned long> >*, std::vector<double>*);
+
+/* Bellman-Ford's single-source shortest path algorithm, in parallel: only
+ * vertices whose distance changed in a round relax their arcs in the next one.
+ * Fills distances and paths, or predecessors (0 for the source and unreachable
+ * vertices), indexed 1..n. Returns false on negative-weight cycles reachable
+ * from the source, detected as soon as the predecessors form a cycle; the
+ * cycle is then stored in the last argument, if given (may be 0)
+ */
+bool bellman_ford(AdjacencyList<>*, unsigned long, double*, std::vector<unsigned long>*, negative_cycle* = 0);
+bool bellman_ford(AdjacencyList<>*, unsigned long, double*, unsigned long*, negative_cycle* = 0);
+
+/* Johnson's all-pairs shortest path algorithm: into caller-allocated n x n
+ * arrays (with dummy row and column 0), or into an AllPairsResult of matching
+ * size (D = double, float or unsigned int). Return false on negative cycles,
+ * stored in the given negative_cycle (may be 0).
+ * The graph is not modified, so several runs may share it concurrently.
+ * Sources are scheduled as set in magical_config, and per-thread load is
+ * reported in the profile, if given (may be 0)
+ */
+bool johnson(AdjacencyList<>*, double**, std::vector<unsigned long>**, negative_cycle* = 0);
+
+template <class D>
+bool johnson(AdjacencyList<>*, AllPairsResult<D>*, parallel_profile* = 0, negative_cycle* = 0);
+
+/* streaming variant: hands each row to the sink as soon as its search ends,
+ * so memory stays O(threads * n) whatever the consumer does with the rows
+ */
+bool johnson(AdjacencyList<>*, apsp_row_sink*, parallel_profile* = 0, negative_cycle* = 0);
+
+/* all-pairs statistics without the n x n matrix: each row of johnson() (or
+ * of batched_distances(), on small integer weights) is reduced as soon as it
+ * is computed, so each thread holds O(n) words (64 + W + 3 per vertex on the
+ * batched path, W the largest weight). A histogram is built if the bin width
+ * (> 0) is given. Returns false on negative cycles
+ */
+bool all_pairs_statistics(AdjacencyList<>*, apsp_statistics*, double = 0, negative_cycle* = 0);
+
+/* Floyd-Warshall's all-pairs shortest path algorithm, blocked into tiles
+ * updated in parallel (with AVX2 when compiled for it), with the same outputs
+ * as johnson(). Keeps n x n working matrices, so it suits dense graphs
+ */
+bool floyd_warshall(AdjacencyList<>*, double**, std::vector<unsigned long>**, negative_cycle* = 0);
+
+template <class D>
+bool floyd_warshall(AdjacencyList<>*, AllPairsResult<D>*, parallel_profile* = 0, negative_cycle* = 0);
+bool floyd_warshall(AdjacencyList<>*, apsp_row_sink*, parallel_profile* = 0, negative_cycle* = 0);
 
-/* Johnson's all-pairs shortest path algorithm */
-bool johnson(AdjacencyList<>*, double**, std::vector<unsigned long>**);
+/* all-pairs shortest paths by floyd_warshall() on dense graphs, johnson()
+ * otherwise, as set by min_density (arcs over n(n-1)) and max_size (vertices)
+ * in the floyd_warshall_shortest_paths block of magical_config
+ */
+template <class D>
+bool all_pairs_shortest_paths(AdjacencyList<>*, AllPairsResult<D>*, parallel_profile* = 0, negative_cycle* = 0);
 
 #endif /* __PATHS_H__ */
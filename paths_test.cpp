@@ -0,0 +1,465 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include "types.h"
+#include "paths.h"
+#include "distance_file.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// total weight of a path, using the cheapest arc between consecutive vertices
+double path_weight(AdjacencyList<> *g, const vector<unsigned long> &path)
+{
+    double total = 0;
+    for (unsigned long i = 1; i<path.size(); ++i)
+    {
+        double cheapest = DBL_MAX;
+        Edge* it = g->get_vertex(path[i-1])->get_adjacencies();
+        while (it)
+        {
+            if (it->get_successor()->get_key() == path[i] && it->get_weight() < cheapest)
+                cheapest = it->get_weight();
+            it = it->get_next();
+        }
+        total += cheapest;
+    }
+
+    return total;
+}
+
+// every simple path from the last vertex of 'path' to 't', by weight (brute force)
+void simple_paths(AdjacencyList<> *g, unsigned long t, vector<unsigned long> &path,
+    vector<bool> &on_path, vector<double> *weights)
+{
+    unsigned long u = path.back();
+    if (u == t)
+    {
+        weights->push_back(path_weight(g, path));
+        return;
+    }
+
+    vector<unsigned long> next;
+    for (Edge* it = g->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+        next.push_back(it->get_successor()->get_key());
+    sort(next.begin(), next.end());
+    next.erase(unique(next.begin(), next.end()), next.end());   // parallel arcs
+
+    for (unsigned long i = 0; i<next.size(); ++i)
+    {
+        if (on_path[next[i]])
+            continue;
+
+        on_path[next[i]] = true;
+        path.push_back(next[i]);
+        simple_paths(g, t, path, on_path, weights);
+        path.pop_back();
+        on_path[next[i]] = false;
+    }
+}
+
+// row sink comparing each row against a complete result
+class row_checker : public apsp_row_sink
+{
+public:
+    row_checker(AllPairsResult<> *r) { expected = r; rows = mismatches = 0; }
+
+    void store_row(unsigned long u, const double *d, const unsigned long*)
+    {
+        unsigned long wrong = 0;
+        for (unsigned long v = 1; v <= expected->get_vertex_count(); ++v)
+        {
+            double e = expected->distance(u, v);
+            if (d[v] != (e == AllPairsResult<>::infinity() ? DBL_MAX : e))
+                ++wrong;
+        }
+
+        #pragma omp critical
+        {
+            ++rows;
+            mismatches += wrong;
+        }
+    }
+
+    unsigned long rows, mismatches;
+
+private:
+    AllPairsResult<> *expected;
+};
+
+// sum of every arc weight in the graph
+double total_weight(AdjacencyList<> *g)
+{
+    double total = 0;
+    for (unsigned long u = 1; u<=g->get_vertex_count(); ++u)
+        for (Edge* it = g->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            total += it->get_weight();
+
+    return total;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    unsigned long num_vertices = 2000;
+    AdjacencyList<> *graph = randomGraph(num_vertices, 4, 100);
+    int errors = 0;
+
+    // reference: full dijkstra from a few sources
+    double *distances = new double[num_vertices+1];
+    vector<unsigned long> *paths = new vector<unsigned long>[num_vertices+1];
+    sssp_workspace ws(num_vertices);
+
+    for (unsigned long source = 1; source <= 5; ++source)
+    {
+        dijkstra(graph, source, distances, paths);
+
+        // targets: settled with exact distances
+        vector<unsigned long> targets;
+        targets.push_back(num_vertices);
+        targets.push_back(num_vertices/2);
+        targets.push_back(num_vertices/2);
+        dijkstra_to_targets(graph, source, targets, &ws);
+
+        for (unsigned long i = 0; i<targets.size(); ++i)
+            errors += check(ws.is_settled(targets[i]) || distances[targets[i]] == DBL_MAX,
+                "target settled");
+        for (unsigned long i = 0; i<targets.size(); ++i)
+            errors += check(ws.get_distance(targets[i]) == distances[targets[i]],
+                "target distance");
+
+        vector<unsigned long> path;
+        ws.get_path(targets[0], &path);
+        if (distances[targets[0]] < DBL_MAX)
+            errors += check(path.front() == source && path.back() == targets[0]
+                && path_weight(graph, path) == distances[targets[0]], "target path");
+
+        // radius: exactly the vertices within distance r are settled
+        double radius = 50;
+        dijkstra_within_radius(graph, source, radius, &ws);
+        for (unsigned long v = 1; v <= num_vertices; ++v)
+        {
+            errors += check(ws.is_settled(v) == (distances[v] <= radius), "radius settled set");
+            if (ws.is_settled(v))
+                errors += check(ws.get_distance(v) == distances[v], "radius distance");
+        }
+
+        // k-nearest: k settled vertices besides the source, closest first
+        unsigned long k = 10;
+        dijkstra_k_nearest(graph, source, k, &ws);
+        const vector<unsigned long> &nearest = ws.get_settled();
+        errors += check(nearest.size() == k+1, "k-nearest count");
+
+        unsigned long closer = 0;
+        for (unsigned long v = 1; v <= num_vertices; ++v)
+            if (v != source && distances[v] < ws.get_distance(nearest.back()))
+                ++closer;
+        errors += check(closer < k, "k-nearest are the closest");
+    }
+
+    // no targets: the workspace is reset all the same
+    dijkstra_to_targets(graph, 1, vector<unsigned long>(), &ws);
+    errors += check(ws.get_settled().empty() && ws.get_distance(1) == DBL_MAX, "no targets");
+
+    // an unknown target throws before any target is marked
+    vector<unsigned long> some_unknown(1, 2);
+    some_unknown.push_back(num_vertices + 1);
+    bool thrown = false;
+    try {
+        dijkstra_to_targets(graph, 1, some_unknown, &ws);
+    } catch (NoSuchVertexException&) {
+        thrown = true;
+    }
+    errors += check(thrown && !ws.is_marked(2), "unknown target");
+
+    // many-to-many: every entry against the full dijkstra from its source
+    vector<unsigned long> sources, targets;
+    for (unsigned long i = 0; i<20; ++i)
+    {
+        sources.push_back((i*97) % num_vertices + 1);
+        targets.push_back((i*31) % num_vertices + 1);
+    }
+    targets.push_back(targets[0]);
+
+    double *table = new double[sources.size() * targets.size()];
+    many_to_many(graph, sources, targets, table);
+
+    for (unsigned long i = 0; i<sources.size(); ++i)
+    {
+        dijkstra(graph, sources[i], distances, paths);
+        for (unsigned long j = 0; j<targets.size(); ++j)
+            errors += check(table[i*targets.size() + j] == distances[targets[j]], "many-to-many entry");
+    }
+
+    // unknown keys throw to the caller, not inside the parallel searches
+    thrown = false;
+    try {
+        sources[1] = num_vertices + 1;
+        many_to_many(graph, sources, targets, table);
+    } catch (NoSuchVertexException&) {
+        thrown = true;
+    }
+    errors += check(thrown, "many-to-many unknown source");
+    delete[] table;
+
+    // yen: the k shortest simple paths against a brute-force enumeration
+    AdjacencyList<> *tiny = randomGraph(14, 4, 10);
+    for (unsigned long t = 2; t <= 14; t += 4)
+    {
+        vector<double> expected;
+        vector<unsigned long> path(1, 1);
+        vector<bool> on_path(15, false);
+        on_path[1] = true;
+        simple_paths(tiny, t, path, on_path, &expected);
+        sort(expected.begin(), expected.end());
+
+        unsigned long k = 25;
+        vector<vector<unsigned long> > yen_paths;
+        vector<double> yen_weights;
+        unsigned long found = k_shortest_paths(tiny, 1, t, k, &yen_paths, &yen_weights);
+
+        errors += check(found == min(k, (unsigned long) expected.size()) && yen_paths.size() == found,
+            "k-shortest paths count");
+        for (unsigned long i = 0; i<found; ++i)
+        {
+            vector<unsigned long> sorted = yen_paths[i];
+            sort(sorted.begin(), sorted.end());
+
+            errors += check(yen_weights[i] == expected[i], "k-shortest paths weight");
+            errors += check(path_weight(tiny, yen_paths[i]) == yen_weights[i], "k-shortest path weight");
+            errors += check(yen_paths[i].front() == 1 && yen_paths[i].back() == t
+                && unique(sorted.begin(), sorted.end()) == sorted.end(), "k-shortest path is simple");
+            for (unsigned long j = 0; j<i; ++j)
+                errors += check(yen_paths[j] != yen_paths[i], "k-shortest paths distinct");
+        }
+    }
+    delete tiny;
+
+    // a single path, and the empty path from a vertex to itself
+    AdjacencyList<> *triangle = new AdjacencyList<>(3);
+    triangle->addEdge(1, 2, 1);
+    triangle->addEdge(2, 3, 1);
+    triangle->addEdge(1, 3, 5);
+    vector<vector<unsigned long> > yen_paths;
+    vector<double> yen_weights;
+    errors += check(k_shortest_paths(triangle, 1, 3, 1, &yen_paths, &yen_weights) == 1 && yen_weights[0] == 2
+        && yen_paths[0].size() == 3, "k-shortest paths, k = 1");
+    errors += check(k_shortest_paths(triangle, 1, 3, 2, &yen_paths, &yen_weights) == 2 && yen_weights[1] == 5,
+        "k-shortest paths, k = 2");
+    errors += check(k_shortest_paths(triangle, 1, 1, 1, &yen_paths, &yen_weights) == 1 && yen_weights[0] == 0
+        && yen_paths[0] == vector<unsigned long>(1, 1), "k-shortest paths to the source, k = 1");
+    errors += check(k_shortest_paths(triangle, 1, 1, 3, &yen_paths, &yen_weights) == 1,
+        "k-shortest paths to the source, k = 3");
+    delete triangle;
+
+    // johnson: legacy arrays and AllPairsResult (with float storage) on a
+    // smaller graph, including negative arcs
+    unsigned long n = 200;
+    AdjacencyList<> *small = randomGraph(n, 3, 50);
+    for (unsigned long u = 1; u <= n; u += 7)
+        small->addEdge(u, (u % n) + 1, -3);
+
+    double **apsp_dist = new double*[n+1];
+    vector<unsigned long> **apsp_paths = new vector<unsigned long>*[n+1];
+    for (unsigned long u = 0; u<=n; ++u)
+    {
+        apsp_dist[u] = new double[n+1];
+        apsp_paths[u] = new vector<unsigned long>[n+1];
+    }
+
+    // both runs share the (read-only) graph concurrently
+    AllPairsResult<float> result(n);
+    double weight_before = total_weight(small);
+    bool ok_arrays = false, ok_result = false;
+
+    #pragma omp parallel sections default(none) shared(small, apsp_dist, apsp_paths, result, ok_arrays, ok_result)
+    {
+        #pragma omp section
+        ok_arrays = johnson(small, apsp_dist, apsp_paths);
+
+        #pragma omp section
+        ok_result = johnson(small, &result);
+    }
+
+    errors += check(ok_arrays, "johnson (arrays)");
+    errors += check(ok_result, "johnson (AllPairsResult)");
+    errors += check(small->get_vertex_count() == n && total_weight(small) == weight_before,
+        "johnson leaves the graph untouched");
+
+    // negative weights give negative distances, which unsigned results cannot hold
+    AllPairsResult<unsigned int> unsigned_result(n);
+    errors += check(!johnson(small, &unsigned_result) && !floyd_warshall(small, &unsigned_result),
+        "unsigned distances refused");
+
+    double *bf_dist = new double[n+1];
+    vector<unsigned long> *bf_paths = new vector<unsigned long>[n+1];
+    for (unsigned long u = 1; u <= n; u += 13)
+    {
+        bellman_ford(small, u, bf_dist, bf_paths);
+        for (unsigned long v = 1; v <= n; ++v)
+        {
+            errors += check(apsp_dist[u][v] == bf_dist[v], "johnson distance");
+            errors += check(result.is_reachable(u, v) == (bf_dist[v] < DBL_MAX), "johnson reachability");
+            if (bf_dist[v] == DBL_MAX)
+                continue;
+
+            errors += check(result.distance(u, v) == (float) bf_dist[v], "AllPairsResult distance");
+            errors += check(bf_paths[v].front() == u && bf_paths[v].back() == v
+                && path_weight(small, bf_paths[v]) == bf_dist[v], "bellman-ford path");
+
+            vector<unsigned long> path;
+            result.path(u, v, &path);
+            errors += check(path == apsp_paths[u][v], "AllPairsResult path");
+            errors += check(path.front() == u && path.back() == v
+                && path_weight(small, path) == bf_dist[v], "johnson path");
+        }
+    }
+
+    // floyd-warshall: same distances and paths as johnson (n is not a multiple
+    // of the tile side); so does the dispatcher
+    AllPairsResult<> fw_result(n), dispatched(n);
+    errors += check(floyd_warshall(small, &fw_result), "floyd-warshall");
+    errors += check(all_pairs_shortest_paths(small, &dispatched), "all_pairs_shortest_paths");
+    for (unsigned long u = 1; u <= n; ++u)
+    {
+        for (unsigned long v = 1; v <= n; ++v)
+        {
+            errors += check(fw_result.distance(u, v) == (apsp_dist[u][v] < DBL_MAX
+                ? apsp_dist[u][v] : AllPairsResult<>::infinity()), "floyd-warshall distance");
+            errors += check(dispatched.distance(u, v) == fw_result.distance(u, v), "dispatched distance");
+            if (!fw_result.is_reachable(u, v))
+                continue;
+
+            vector<unsigned long> path;
+            fw_result.path(u, v, &path);
+            errors += check(path.front() == u && path.back() == v
+                && path_weight(small, path) == apsp_dist[u][v], "floyd-warshall path");
+        }
+    }
+
+    // streaming: every row reaches a custom sink once, and the file sink
+    // writes the whole matrix
+    row_checker checker(&fw_result);
+    errors += check(johnson(small, &checker), "johnson (row sink)");
+    errors += check(checker.rows == n && checker.mismatches == 0, "rows given to the sink");
+
+    {
+        apsp_file_sink file_sink("/tmp/magical_apsp.bin", n);
+        errors += check(johnson(small, &file_sink) && file_sink.good(), "johnson (file sink)");
+    }
+
+    vector<double> row(n);
+    FILE *fh = fopen("/tmp/magical_apsp.bin", "rb");
+    for (unsigned long u = 1; fh && u <= n; ++u)
+    {
+        errors += check(fread(&row[0], sizeof(double), n, fh) == n, "file sink row");
+        for (unsigned long v = 1; v <= n; ++v)
+            errors += check(row[v-1] == apsp_dist[u][v], "file sink distance");
+    }
+    errors += check(fh != 0, "file sink output");
+    if (fh)
+        fclose(fh);
+
+    // out-of-core matrix: rows from both engines, tiles not dividing n
+    distance_file_writer writer;
+    errors += check(writer.create("/tmp/magical_apsp.dm", n, 48), "distance file creation");
+    errors += check(johnson(small, &writer), "johnson (distance file)");
+    errors += check(writer.close(), "distance file writing");
+
+    distance_file matrix;
+    errors += check(matrix.open("/tmp/magical_apsp.dm") && matrix.get_vertex_count() == n, "distance file reading");
+    for (unsigned long u = 1; u <= matrix.get_vertex_count(); ++u)
+        for (unsigned long v = 1; v <= n; ++v)
+            errors += check(matrix.distance(u, v) == apsp_dist[u][v], "distance file entry");
+    matrix.close();
+
+    errors += check(writer.create("/tmp/magical_apsp.dm", n) && floyd_warshall(small, &writer)
+        && writer.close() && matrix.open("/tmp/magical_apsp.dm"), "floyd-warshall (distance file)");
+    for (unsigned long u = 1; u <= matrix.get_vertex_count(); ++u)
+        for (unsigned long v = 1; v <= n; ++v)
+            errors += check(matrix.distance(u, v) == apsp_dist[u][v], "distance file entry");
+
+    // statistics: against values computed from the complete result
+    apsp_statistics stats;
+    errors += check(all_pairs_statistics(small, &stats, 10), "all-pairs statistics");
+
+    double diameter = 0, total = 0;
+    unsigned long pairs = 0, histogram_total = 0;
+    for (unsigned long u = 1; u <= n; ++u)
+    {
+        double eccentricity = 0;
+        unsigned long count = 0;
+        for (unsigned long v = 1; v <= n; ++v)
+        {
+            if (u == v || !fw_result.is_reachable(u, v))
+                continue;
+
+            double d = fw_result.distance(u, v);
+            eccentricity = (count++ == 0) ? d : max(eccentricity, d);
+            total += d;
+
+            long bin = (long) floor(d / 10) - stats.histogram_first;
+            errors += check(bin >= 0 && bin < (long) stats.histogram.size(), "histogram range");
+        }
+
+        errors += check(stats.eccentricity[u] == eccentricity, "eccentricity");
+        diameter = (pairs == 0 && count > 0) ? eccentricity : max(diameter, eccentricity);
+        pairs += count;
+    }
+
+    for (unsigned long i = 0; i<stats.histogram.size(); ++i)
+        histogram_total += stats.histogram[i];
+
+    errors += check(stats.reachable_pairs == pairs && histogram_total == pairs, "reachable pairs");
+    errors += check(stats.diameter == diameter, "diameter");
+    errors += check(fabs(stats.average - total / pairs) < 1e-9, "average distance");
+
+    // negative-weight cycle 10 -> 11 -> 12 -> 10: found by every algorithm
+    small->addEdge(10, 11, -20);
+    small->addEdge(11, 12, -20);
+    small->addEdge(12, 10, -20);
+    negative_cycle bf_cycle, johnson_cycle, fw_cycle;
+    errors += check(!bellman_ford(small, 10, bf_dist, bf_paths, &bf_cycle), "bellman-ford negative cycle");
+    errors += check(!johnson(small, &result, 0, &johnson_cycle), "johnson negative cycle");
+    errors += check(!floyd_warshall(small, &fw_result, 0, &fw_cycle), "floyd-warshall negative cycle");
+
+    // reported cycles: closed walks along existing arcs, of negative weight
+    negative_cycle *cycles[] = { &bf_cycle, &johnson_cycle, &fw_cycle };
+    for (int c = 0; c<3; ++c)
+    {
+        vector<unsigned long> walk = cycles[c]->vertices;
+        errors += check(!walk.empty(), "negative cycle reported");
+        if (walk.empty())
+            continue;
+
+        walk.push_back(walk.front());
+        double weight = path_weight(small, walk);
+        errors += check(weight < DBL_MAX && weight == cycles[c]->weight && weight < 0, "negative cycle weight");
+    }
+
+    for (unsigned long u = 0; u<=n; ++u)
+    {
+        delete[] apsp_dist[u];
+        delete[] apsp_paths[u];
+    }
+    delete[] apsp_dist;
+    delete[] apsp_paths;
+    delete[] bf_dist;
+    delete[] bf_paths;
+    delete small;
+
+    cout << errors << " errors" << endl;
+
+    delete[] distances;
+    delete[] paths;
+    delete graph;
+
+    return errors;
+}
@@ -0,0 +1,626 @@
+#include "query_server.h"
+#include "paths.h"
+#include "analysis.h"
+#include "mst.h"
+#include <omp.h>
+#include <cfloat>       // for DBL_MAX
+#include <cerrno>
+#include <cstdlib>      // for atoi
+#include <cstring>
+#include <iostream>
+#include <unistd.h>     // for read, close, unlink
+#include <sys/socket.h>
+#include <sys/un.h>     // for sockaddr_un
+#include "magical_config.h"
+
+#define ulong unsigned long
+
+// largest many-to-many query: keys on either side, and table entries
+#define QUERY_MAX_KEYS    (1UL << 20)
+#define QUERY_MAX_TABLE   (1UL << 24)
+
+using namespace std;
+
+struct pending_query
+{
+    query_request request;
+    vector<ulong> keys;           // many-to-many: sources, then targets
+
+    query_reply reply;
+    vector<double> distances;
+    vector<ulong> path;
+
+    bool done;                    // reply ready (guarded by the server lock)
+};
+
+struct server_connection
+{
+    query_server *server;
+    int fd;                       // -1 once closed by its thread
+    pthread_t thread;
+    bool finished;
+};
+
+// whole buffers through a socket, despite short transfers and signals
+static bool read_all(int fd, void *buffer, size_t size)
+{
+    char *p = (char*) buffer;
+    while (size > 0)
+    {
+        ssize_t r = ::read(fd, p, size);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+
+        p += r;
+        size -= r;
+    }
+
+    return true;
+}
+
+static bool write_all(int fd, const void *buffer, size_t size)
+{
+    const char *p = (const char*) buffer;
+    while (size > 0)
+    {
+        ssize_t w = ::send(fd, p, size, MSG_NOSIGNAL);   // no SIGPIPE from closed peers
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return false;
+
+        p += w;
+        size -= w;
+    }
+
+    return true;
+}
+
+// unix socket address for a path; false if it does not fit
+static bool socket_address(const char *path, sockaddr_un *address)
+{
+    memset(address, 0, sizeof(sockaddr_un));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path))
+        return false;
+
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+/*
+ * Server implementation
+ */
+
+query_server::query_server(AdjacencyList<> *g)
+{
+    graph = g;
+    listen_fd = -1;
+    running = workers_running = false;
+    threads_per_worker = 1;
+    answered_count = batched_count = 0;
+    mst_known = false;
+    mst_status = QUERY_OK;
+    mst_weight = 0;
+
+    pthread_mutex_init(&lock, 0);
+    pthread_mutex_init(&mst_lock, 0);
+    pthread_cond_init(&queued, 0);
+    pthread_cond_init(&answered, 0);
+}
+
+query_server::~query_server()
+{
+    stop();
+
+    pthread_cond_destroy(&answered);
+    pthread_cond_destroy(&queued);
+    pthread_mutex_destroy(&mst_lock);
+    pthread_mutex_destroy(&lock);
+}
+
+bool query_server::start(const char *path, unsigned int num_workers)
+{
+    if (running)
+        return false;
+
+    sockaddr_un address;
+    if (!socket_address(path, &address))
+    {
+        cerr << "[magical] socket path too long: " << path << endl;
+        return false;
+    }
+
+    ::unlink(path);   // left by a previous run
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (sockaddr*) &address, sizeof(address)) != 0
+        || listen(listen_fd, SOMAXCONN) != 0)
+    {
+        cerr << "[magical] could not listen at " << path << endl;
+        if (listen_fd >= 0)
+            ::close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    socket_path = path;
+
+    // configuration is read before any worker may ask for it
+    if ( !magical_config::load_settings("server", graph->get_vertex_count()) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    if (num_workers == 0)
+    {
+        string setting = magical_config::get_setting("server", "workers");
+        num_workers = setting.empty() ? 0 : atoi(setting.c_str());
+    }
+    if (num_workers == 0)
+        num_workers = omp_get_num_procs();
+
+    // the workers share the threads of the server
+    threads_per_worker = max(1, omp_get_max_threads() / (int) num_workers);
+
+    analyze_graph(graph);   // cached for every query
+
+    running = workers_running = true;
+    workers.resize(num_workers);
+    for (unsigned int i = 0; i<num_workers; ++i)
+        pthread_create(&workers[i], 0, worker_loop, this);
+    pthread_create(&acceptor, 0, accept_loop, this);
+
+    return true;
+}
+
+void query_server::stop()
+{
+    if (!running)
+        return;
+
+    // no more connections
+    pthread_mutex_lock(&lock);
+    running = false;
+    pthread_mutex_unlock(&lock);
+
+    shutdown(listen_fd, SHUT_RDWR);   // wakes the acceptor
+    pthread_join(acceptor, 0);
+
+    // no more requests: each connection gets the answer it may be waiting for
+    pthread_mutex_lock(&lock);
+    for (ulong i = 0; i<connections.size(); ++i)
+        if (connections[i]->fd >= 0)
+            shutdown(connections[i]->fd, SHUT_RDWR);
+    pthread_mutex_unlock(&lock);
+
+    for (ulong i = 0; i<connections.size(); ++i)
+    {
+        pthread_join(connections[i]->thread, 0);
+        delete connections[i];
+    }
+    connections.clear();
+
+    pthread_mutex_lock(&lock);
+    workers_running = false;
+    pthread_cond_broadcast(&queued);
+    pthread_mutex_unlock(&lock);
+
+    for (ulong i = 0; i<workers.size(); ++i)
+        pthread_join(workers[i], 0);
+    workers.clear();
+
+    ::close(listen_fd);
+    listen_fd = -1;
+    ::unlink(socket_path.c_str());
+}
+
+unsigned long query_server::get_answered_count()
+{
+    pthread_mutex_lock(&lock);
+    ulong count = answered_count;
+    pthread_mutex_unlock(&lock);
+
+    return count;
+}
+
+unsigned long query_server::get_batched_count()
+{
+    pthread_mutex_lock(&lock);
+    ulong count = batched_count;
+    pthread_mutex_unlock(&lock);
+
+    return count;
+}
+
+void* query_server::accept_loop(void *arg)
+{
+    query_server *server = (query_server*) arg;
+
+    for (;;)
+    {
+        int fd = accept(server->listen_fd, 0, 0);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;   // shut down by stop()
+        }
+
+        pthread_mutex_lock(&server->lock);
+        if (!server->running)
+        {
+            pthread_mutex_unlock(&server->lock);
+            ::close(fd);
+            break;
+        }
+
+        // reaps the threads of closed connections
+        vector<server_connection*> &connections = server->connections;
+        for (ulong i = 0; i<connections.size(); )
+        {
+            if (connections[i]->finished)
+            {
+                pthread_join(connections[i]->thread, 0);
+                delete connections[i];
+                connections[i] = connections.back();
+                connections.pop_back();
+            }
+            else
+                ++i;
+        }
+
+        server_connection *c = new server_connection;
+        c->server = server;
+        c->fd = fd;
+        c->finished = false;
+        connections.push_back(c);
+        pthread_create(&c->thread, 0, connection_loop, c);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return 0;
+}
+
+void* query_server::connection_loop(void *arg)
+{
+    server_connection *c = (server_connection*) arg;
+    query_server *server = c->server;
+    int fd = c->fd;
+
+    pending_query q;
+    while (read_all(fd, &q.request, sizeof(query_request)))
+    {
+        q.keys.clear();
+        q.distances.clear();
+        q.path.clear();
+
+        ulong op = q.request.op, a = q.request.a, b = q.request.b;
+        bool valid = op == QUERY_PATH || op == QUERY_MST_WEIGHT
+            || (op == QUERY_MANY_TO_MANY && a <= QUERY_MAX_KEYS && b <= QUERY_MAX_KEYS
+                && a * b <= QUERY_MAX_TABLE);
+
+        if (!valid)
+        {
+            // what follows cannot be told apart: the connection ends here
+            query_reply reply = { QUERY_BAD_REQUEST, 0, 0 };
+            write_all(fd, &reply, sizeof(query_reply));
+            break;
+        }
+
+        if (op == QUERY_MANY_TO_MANY)
+        {
+            q.keys.resize(a + b);
+            if (a + b > 0 && !read_all(fd, &q.keys[0], (a + b) * sizeof(ulong)))
+                break;
+        }
+
+        // evaluation by a worker
+        pthread_mutex_lock(&server->lock);
+        q.done = false;
+        server->queue.push_back(&q);
+        pthread_cond_signal(&server->queued);
+        while (!q.done)
+            pthread_cond_wait(&server->answered, &server->lock);
+        pthread_mutex_unlock(&server->lock);
+
+        bool sent = write_all(fd, &q.reply, sizeof(query_reply))
+            && (q.distances.empty() || write_all(fd, &q.distances[0], q.distances.size() * sizeof(double)))
+            && (q.path.empty() || write_all(fd, &q.path[0], q.path.size() * sizeof(ulong)));
+        if (!sent)
+            break;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    ::close(fd);
+    c->fd = -1;
+    c->finished = true;
+    pthread_mutex_unlock(&server->lock);
+
+    return 0;
+}
+
+void* query_server::worker_loop(void *arg)
+{
+    query_server *server = (query_server*) arg;
+    magical_config::set_thread_limit(server->threads_per_worker);
+
+    sssp_workspace ws(server->graph->get_vertex_count());
+    vector<pending_query*> batch;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&server->lock);
+        while (server->queue.empty() && server->workers_running)
+            pthread_cond_wait(&server->queued, &server->lock);
+
+        if (server->queue.empty())
+        {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+
+        batch.clear();
+        batch.push_back(server->queue.front());
+        server->queue.pop_front();
+
+        // path queries from the same source, answered by the same search
+        if (batch[0]->request.op == QUERY_PATH)
+        {
+            deque<pending_query*>::iterator it = server->queue.begin();
+            while (it != server->queue.end())
+            {
+                if ((*it)->request.op == QUERY_PATH && (*it)->request.a == batch[0]->request.a)
+                {
+                    batch.push_back(*it);
+                    it = server->queue.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        server->evaluate(batch, &ws);
+
+        pthread_mutex_lock(&server->lock);
+        for (ulong i = 0; i<batch.size(); ++i)
+            batch[i]->done = true;
+        server->answered_count += batch.size();
+        server->batched_count += batch.size() - 1;
+        pthread_cond_broadcast(&server->answered);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return 0;
+}
+
+void query_server::evaluate(vector<pending_query*> &batch, sssp_workspace *ws)
+{
+    pending_query *q = batch[0];
+    q->reply.status = QUERY_OK;
+
+    if (q->request.op == QUERY_PATH)
+        evaluate_paths(batch, ws);
+    else if (q->request.op == QUERY_MST_WEIGHT)
+        evaluate_mst(q);
+    else
+    {
+        ulong num_vertices = graph->get_vertex_count();
+        ulong a = q->request.a, b = q->request.b;
+
+        for (ulong k = 0; k<q->keys.size(); ++k)
+            if (q->keys[k] < 1 || q->keys[k] > num_vertices)
+                q->reply.status = QUERY_NO_SUCH_VERTEX;
+
+        if (q->reply.status == QUERY_OK)
+        {
+            vector<ulong> sources(q->keys.begin(), q->keys.begin() + a);
+            vector<ulong> targets(q->keys.begin() + a, q->keys.end());
+            q->distances.resize(a * b);
+
+            if (analyze_graph(graph).nonnegative)
+            {
+                if (a * b > 0)
+                    ::many_to_many(graph, sources, targets, &q->distances[0]);
+            }
+            else
+            {
+                // one full search per source (negative arcs)
+                for (ulong i = 0; i<a && q->reply.status == QUERY_OK; ++i)
+                {
+                    if (shortest_paths(graph, sources[i], ws) == SSSP_NEGATIVE_CYCLE)
+                        q->reply.status = QUERY_FAILED;
+
+                    for (ulong j = 0; j<b; ++j)
+                        q->distances[i*b + j] = ws->get_distance(targets[j]);
+                }
+            }
+
+            if (q->reply.status != QUERY_OK)
+                q->distances.clear();
+        }
+    }
+
+    for (ulong i = 0; i<batch.size(); ++i)
+    {
+        batch[i]->reply.distance_count = batch[i]->distances.size();
+        batch[i]->reply.key_count = batch[i]->path.size();
+    }
+}
+
+// a batch of path queries from the same source
+void query_server::evaluate_paths(vector<pending_query*> &batch, sssp_workspace *ws)
+{
+    ulong num_vertices = graph->get_vertex_count();
+    ulong source = batch[0]->request.a;
+
+    vector<ulong> targets;
+    for (ulong i = 0; i<batch.size(); ++i)
+    {
+        ulong t = batch[i]->request.b;
+        bool valid = source >= 1 && source <= num_vertices && t >= 1 && t <= num_vertices;
+
+        batch[i]->reply.status = valid ? QUERY_OK : QUERY_NO_SUCH_VERTEX;
+        if (valid)
+            targets.push_back(t);
+    }
+
+    if (targets.empty())
+        return;
+
+    int status = QUERY_OK;
+    if (analyze_graph(graph).nonnegative)
+        dijkstra_to_targets(graph, source, targets, ws);
+    else if (shortest_paths(graph, source, ws) == SSSP_NEGATIVE_CYCLE)
+        status = QUERY_FAILED;
+
+    for (ulong i = 0; i<batch.size(); ++i)
+    {
+        pending_query *q = batch[i];
+        if (q->reply.status != QUERY_OK)
+            continue;
+
+        q->reply.status = status;
+        if (status == QUERY_OK)
+        {
+            q->distances.assign(1, ws->get_distance(q->request.b));
+            ws->get_path(q->request.b, &q->path);
+        }
+    }
+}
+
+// the weight of the mst, computed by the first query asking for it
+void query_server::evaluate_mst(pending_query *q)
+{
+    pthread_mutex_lock(&mst_lock);
+    if (!mst_known)
+    {
+        AdjacencyList<> *mst = new AdjacencyList<>(graph->get_vertex_count());
+        mst_status = boruvka(graph, mst) ? QUERY_OK : QUERY_FAILED;
+
+        // each tree edge appears as two arcs
+        double weight = 0;
+        for (ulong u = 1; u<=mst->get_vertex_count(); ++u)
+            for (Edge* it = mst->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+                weight += it->get_weight();
+        mst_weight = weight / 2;
+
+        delete mst;
+        mst_known = true;
+    }
+    pthread_mutex_unlock(&mst_lock);
+
+    q->reply.status = mst_status;
+    if (mst_status == QUERY_OK)
+        q->distances.assign(1, mst_weight);
+}
+
+/*
+ * Client implementation
+ */
+
+query_client::query_client()
+{
+    fd = -1;
+}
+
+query_client::~query_client()
+{
+    close();
+}
+
+bool query_client::connect(const char *path)
+{
+    close();
+
+    sockaddr_un address;
+    if (!socket_address(path, &address))
+        return false;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, (sockaddr*) &address, sizeof(address)) != 0)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void query_client::close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+}
+
+int query_client::exchange(const query_request &request, const vector<ulong> &keys,
+    vector<double> *distances, vector<ulong> *path)
+{
+    query_reply reply;
+
+    bool ok = fd >= 0 && write_all(fd, &request, sizeof(query_request))
+        && (keys.empty() || write_all(fd, &keys[0], keys.size() * sizeof(ulong)))
+        && read_all(fd, &reply, sizeof(query_reply));
+
+    if (ok)
+    {
+        distances->resize(reply.distance_count);
+        path->resize(reply.key_count);
+        ok = (distances->empty() || read_all(fd, &(*distances)[0], distances->size() * sizeof(double)))
+            && (path->empty() || read_all(fd, &(*path)[0], path->size() * sizeof(ulong)));
+    }
+
+    if (!ok)
+    {
+        close();
+        return QUERY_DISCONNECTED;
+    }
+
+    return reply.status;
+}
+
+int query_client::shortest_path(ulong s, ulong t, double *distance, vector<ulong> *path)
+{
+    query_request request = { QUERY_PATH, s, t };
+    vector<double> distances;
+    vector<ulong> keys;
+
+    int status = exchange(request, vector<ulong>(), &distances, &keys);
+    if (status == QUERY_OK)
+    {
+        *distance = distances[0];
+        if (path)
+            path->swap(keys);
+    }
+
+    return status;
+}
+
+int query_client::many_to_many(const vector<ulong> &sources, const vector<ulong> &targets,
+    vector<double> *table)
+{
+    query_request request = { QUERY_MANY_TO_MANY, sources.size(), targets.size() };
+    vector<ulong> keys(sources);
+    keys.insert(keys.end(), targets.begin(), targets.end());
+    vector<ulong> path;
+
+    return exchange(request, keys, table, &path);
+}
+
+int query_client::mst_weight(double *weight)
+{
+    query_request request = { QUERY_MST_WEIGHT, 0, 0 };
+    vector<double> distances;
+    vector<ulong> keys;
+
+    int status = exchange(request, vector<ulong>(), &distances, &keys);
+    if (status == QUERY_OK)
+        *weight = distances[0];
+
+    return status;
+}
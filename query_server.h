@@ -0,0 +1,131 @@
+#ifndef __QUERY_SERVER_H__
+#define __QUERY_SERVER_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <pthread.h>
+#include "types.h"
+#include "sssp_workspace.h"
+
+/* protocol: a client sends a query_request, followed for many-to-many queries
+ * by the source keys then the target keys (unsigned longs), and gets a
+ * query_reply, followed by its doubles then its keys. Requests on a
+ * connection are answered in order, one at a time; structures are sent as in
+ * memory (the socket is local, so both ends share the architecture)
+ */
+#define QUERY_PATH           1   // a: source, b: target. Reply: distance, path keys
+#define QUERY_MANY_TO_MANY   2   // a: |S|, b: |T|. Reply: |S|x|T| distances, row-major
+#define QUERY_MST_WEIGHT     3   // reply: weight of a minimum spanning tree
+
+#define QUERY_OK             0
+#define QUERY_BAD_REQUEST    1   // unknown operation, or too large
+#define QUERY_NO_SUCH_VERTEX 2
+#define QUERY_FAILED         3   // e.g. negative cycle, or disconnected graph for the mst
+#define QUERY_DISCONNECTED   4   // client side: the server could not be reached
+
+typedef struct {
+    unsigned long op;
+    unsigned long a, b;
+} query_request;
+
+typedef struct {
+    unsigned long status;
+    unsigned long distance_count, key_count;   // sizes of what follows
+} query_reply;
+
+struct pending_query;   // a request waiting for (or under) evaluation
+struct server_connection;
+
+/**
+ * query_server: answers queries on a resident graph over a Unix-domain
+ * socket, so the graph is loaded once (e.g. from a snapshot) for many short
+ * jobs. Each connection gets a thread which reads its requests; their
+ * evaluation goes to a pool of workers, each with its own workspace and an
+ * equal share of the cores for the parallel algorithms it runs. A worker
+ * taking a path query also takes every queued path query from the same source,
+ * answering them all with a single search. The mst is computed once, at the
+ * first query asking for it.
+ *
+ * The graph must not change while the server runs.
+ */
+class query_server
+{
+public:
+    // constructor and destructor (which stops the server)
+    query_server(AdjacencyList<>*);
+    virtual ~query_server();
+
+    /* listens at the given path with the given number of workers (0: workers
+     * of server in magical_config, or the number of cores); returns false if
+     * the socket cannot be bound
+     */
+    bool start(const char*, unsigned int = 0);
+
+    // closes the socket and every connection, once the queries being evaluated are answered
+    void stop();
+
+    // queries answered so far, and those answered by the search of another one
+    unsigned long get_answered_count();
+    unsigned long get_batched_count();
+
+private:
+    static void* accept_loop(void*);
+    static void* connection_loop(void*);
+    static void* worker_loop(void*);
+
+    void evaluate(std::vector<pending_query*>&, sssp_workspace*);
+    void evaluate_paths(std::vector<pending_query*>&, sssp_workspace*);
+    void evaluate_mst(pending_query*);
+
+    AdjacencyList<>* graph;
+    std::string socket_path;
+    int listen_fd;
+    bool running, workers_running;
+    unsigned int threads_per_worker;
+
+    pthread_t acceptor;
+    std::vector<pthread_t> workers;
+    std::vector<server_connection*> connections;
+
+    // queue of pending queries, and answers (guarded by lock)
+    pthread_mutex_t lock;
+    pthread_cond_t queued, answered;
+    std::deque<pending_query*> queue;
+    unsigned long answered_count, batched_count;
+
+    pthread_mutex_t mst_lock;
+    bool mst_known;
+    int mst_status;
+    double mst_weight;
+};
+
+/* query_client: blocking queries to a query_server. Each returns the status
+ * of the reply (QUERY_DISCONNECTED if the server cannot be reached)
+ */
+class query_client
+{
+public:
+    // constructor and destructor (which closes the connection)
+    query_client();
+    virtual ~query_client();
+
+    bool connect(const char*);
+    void close();
+
+    // s->t distance (DBL_MAX if unreachable) and path (both ends included; may be 0)
+    int shortest_path(unsigned long, unsigned long, double*, std::vector<unsigned long>*);
+
+    // distance table as many_to_many() in paths.h
+    int many_to_many(const std::vector<unsigned long>&, const std::vector<unsigned long>&, std::vector<double>*);
+
+    int mst_weight(double*);
+
+private:
+    int exchange(const query_request&, const std::vector<unsigned long>&,
+        std::vector<double>*, std::vector<unsigned long>*);
+
+    int fd;
+};
+
+#endif /* __QUERY_SERVER_H__ */
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cfloat>
+#include <omp.h>
+#include <unistd.h>   // for getpid
+#include "types.h"
+#include "paths.h"
+#include "mst.h"
+#include "snapshot.h"
+#include "query_server.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// whether the arcs of both graphs, and their order, match
+bool same_graph(AdjacencyList<> *g, AdjacencyList<> *h)
+{
+    if (g->get_vertex_count() != h->get_vertex_count() || h->get_x(7) != g->get_x(7) || h->get_y(7) != g->get_y(7))
+        return false;
+
+    for (unsigned long u = 1; u<=g->get_vertex_count(); ++u)
+    {
+        Edge *a = g->get_vertex(u)->get_adjacencies(), *b = h->get_vertex(u)->get_adjacencies();
+        for (; a && b; a = a->get_next(), b = b->get_next())
+            if (a->get_successor()->get_key() != b->get_successor()->get_key() || a->get_weight() != b->get_weight())
+                return false;
+
+        if (a || b)
+            return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 5000;
+
+    char snapshot_path[64], socket_path[64];
+    sprintf(snapshot_path, "/tmp/magical_snapshot_%d", (int) getpid());
+    sprintf(socket_path, "/tmp/magical_server_%d", (int) getpid());
+
+    // snapshots restore the graph
+    AdjacencyList<> *original = randomUndirectedGraph(n, 4, 100);
+    for (unsigned long v = 1; v<=n; ++v)
+        original->set_coordinates(v, v % 100, v / 100);
+    errors += check(save_snapshot(original, snapshot_path), "save snapshot");
+    AdjacencyList<> *g = graph_from_snapshot(snapshot_path);
+    errors += check(g != 0 && same_graph(original, g), "load snapshot");
+    remove(snapshot_path);
+    delete original;
+
+    query_server server(g);
+    errors += check(server.start(socket_path, 4), "start");
+
+    // clients asking for paths from a few sources, concurrently
+    unsigned long num_clients = 8, per_client = 50;
+    vector<unsigned long> sources(4);
+    for (unsigned long k = 0; k<sources.size(); ++k)
+        sources[k] = (rand() % n) + 1;
+
+    vector<unsigned long> source(num_clients * per_client), target(num_clients * per_client);
+    vector<double> distance(num_clients * per_client);
+    vector<vector<unsigned long> > path(num_clients * per_client);
+    for (unsigned long i = 0; i<source.size(); ++i)
+    {
+        source[i] = sources[rand() % sources.size()];
+        target[i] = (rand() % n) + 1;
+    }
+
+    int client_errors = 0;
+    double start = omp_get_wtime();
+
+    #pragma omp parallel for num_threads(num_clients) schedule(static, 1) reduction(+:client_errors)
+    for (long c = 0; c < (long) num_clients; ++c)
+    {
+        query_client client;
+        client_errors += !client.connect(socket_path);
+
+        for (unsigned long k = c * per_client; k < (c+1) * per_client; ++k)
+            client_errors += client.shortest_path(source[k], target[k], &distance[k], &path[k]) != QUERY_OK;
+    }
+
+    double serve_time = omp_get_wtime() - start;
+    errors += check(client_errors == 0, "path queries");
+
+    // answers against local searches
+    sssp_workspace ws(n);
+    for (unsigned long k = 0; k<source.size(); ++k)
+    {
+        dijkstra(g, source[k], &ws);
+        errors += check(distance[k] == ws.get_distance(target[k]), "served distance");
+
+        // the cheapest of parallel arcs along the path
+        double length = 0;
+        for (unsigned long i = 1; i<path[k].size(); ++i)
+        {
+            double w = DBL_MAX;
+            for (Edge* e = g->get_vertex(path[k][i-1])->get_adjacencies(); e; e = e->get_next())
+                if (e->get_successor()->get_key() == path[k][i])
+                    w = min(w, e->get_weight());
+            length += w;
+        }
+        errors += check(!path[k].empty() && path[k].front() == source[k] && path[k].back() == target[k]
+            && length == distance[k], "served path");
+    }
+
+    cout << source.size() << " path queries from " << num_clients << " clients in " << serve_time << "s, "
+        << server.get_batched_count() << " batched" << endl;
+
+    // many-to-many and mst
+    query_client client;
+    errors += check(client.connect(socket_path), "connect");
+
+    vector<unsigned long> from(10), to(30);
+    for (unsigned long k = 0; k<from.size(); ++k) from[k] = (rand() % n) + 1;
+    for (unsigned long k = 0; k<to.size(); ++k) to[k] = (rand() % n) + 1;
+
+    vector<double> served, table(from.size() * to.size());
+    errors += check(client.many_to_many(from, to, &served) == QUERY_OK && served.size() == table.size(), "many-to-many");
+    many_to_many(g, from, to, &table[0]);
+    errors += check(served == table, "served table");
+
+    AdjacencyList<> *mst = new AdjacencyList<>(n);
+    boruvka(g, mst);
+    double weight = 0, served_weight = -1;
+    for (unsigned long u = 1; u<=n; ++u)
+        for (Edge* it = mst->get_vertex(u)->get_adjacencies(); it; it = it->get_next())
+            weight += it->get_weight();
+    errors += check(client.mst_weight(&served_weight) == QUERY_OK && served_weight == weight / 2, "mst weight");
+    errors += check(client.mst_weight(&served_weight) == QUERY_OK && served_weight == weight / 2, "cached mst weight");
+
+    // errors keep the connection
+    double d;
+    errors += check(client.shortest_path(1, n+1, &d, 0) == QUERY_NO_SUCH_VERTEX, "unknown target");
+    errors += check(client.many_to_many(vector<unsigned long>(1, 0), to, &served) == QUERY_NO_SUCH_VERTEX, "unknown source");
+    errors += check(client.shortest_path(1, 2, &d, 0) == QUERY_OK, "query after an error");
+
+    errors += check(server.get_answered_count() == source.size() + 6, "answered count");
+
+    server.stop();
+    errors += check(client.shortest_path(1, 2, &d, 0) == QUERY_DISCONNECTED, "stopped server");
+    errors += check(!client.connect(socket_path), "connect to a stopped server");
+
+    delete mst;
+    delete g;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}
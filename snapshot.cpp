@@ -0,0 +1,108 @@
+#include "snapshot.h"
+#include "binary_io.h"
+#include <cstring>
+#include <iostream>
+
+#define ulong unsigned long
+
+#define GS_FILE_MAGIC "MAGICGS1"
+
+using namespace std;
+
+bool save_snapshot(AdjacencyList<> *graph, const char *filename)
+{
+    ulong num_vertices = graph->get_vertex_count();
+
+    // arcs of u at [first[u], first[u+1])
+    vector<ulong> first(num_vertices+2, 0), head;
+    vector<double> weight;
+    for (ulong u = 1; u<=num_vertices; ++u)
+    {
+        first[u] = head.size();
+
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            head.push_back(it->get_successor()->get_key());
+            weight.push_back(it->get_weight());
+            it = it->get_next();   // next edge
+        }
+    }
+    first[num_vertices+1] = head.size();
+
+    vector<double> xcoord, ycoord;
+    if (graph->has_coordinates())
+    {
+        xcoord.resize(num_vertices+1);
+        ycoord.resize(num_vertices+1);
+        for (ulong v = 1; v<=num_vertices; ++v)
+        {
+            xcoord[v] = graph->get_x(v);
+            ycoord[v] = graph->get_y(v);
+        }
+    }
+
+    FILE *fh = fopen(filename, "wb");
+    if (!fh)
+    {
+        cerr << "[magical] could not create file " << filename << endl;
+        return false;
+    }
+
+    bool ok = fwrite(GS_FILE_MAGIC, 1, 8, fh) == 8
+        && write_vector(fh, first) && write_vector(fh, head) && write_vector(fh, weight)
+        && write_vector(fh, xcoord) && write_vector(fh, ycoord);
+
+    ok = (fclose(fh) == 0) && ok;
+    if (!ok)
+        cerr << "[magical] could not write file " << filename << endl;
+
+    return ok;
+}
+
+AdjacencyList<>* graph_from_snapshot(const char *filename)
+{
+    FILE *fh = fopen(filename, "rb");
+    if (!fh)
+    {
+        cerr << "[magical] could not open file " << filename << endl;
+        return 0;
+    }
+
+    char magic[8];
+    vector<ulong> first, head;
+    vector<double> weight, xcoord, ycoord;
+
+    bool ok = fread(magic, 1, 8, fh) == 8 && memcmp(magic, GS_FILE_MAGIC, 8) == 0
+        && read_vector(fh, first) && read_vector(fh, head) && read_vector(fh, weight)
+        && read_vector(fh, xcoord) && read_vector(fh, ycoord);
+    fclose(fh);
+
+    // consistent rows, heads and coordinates
+    ulong num_vertices = first.size() < 2 ? 0 : first.size() - 2;
+    ok = ok && first.size() >= 2 && weight.size() == head.size() && first[num_vertices+1] == head.size()
+        && (xcoord.empty() || (xcoord.size() == num_vertices+1 && ycoord.size() == num_vertices+1));
+    for (ulong u = 1; ok && u<=num_vertices; ++u)
+        ok = first[u] <= first[u+1];
+    for (ulong k = 0; ok && k<head.size(); ++k)
+        ok = head[k] >= 1 && head[k] <= num_vertices;
+
+    if (!ok)
+    {
+        cerr << "[magical] invalid graph snapshot " << filename << endl;
+        return 0;
+    }
+
+    AdjacencyList<> *graph = new AdjacencyList<>(num_vertices);
+
+    // edges are inserted at the head of their lists: backwards keeps the order
+    for (ulong u = 1; u<=num_vertices; ++u)
+        for (ulong k = first[u+1]; k > first[u]; --k)
+            graph->addEdge(u, head[k-1], weight[k-1]);
+
+    if (!xcoord.empty())
+        for (ulong v = 1; v<=num_vertices; ++v)
+            graph->set_coordinates(v, xcoord[v], ycoord[v]);
+
+    return graph;
+}
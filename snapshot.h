@@ -0,0 +1,18 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include "types.h"
+
+/* binary graph snapshots, much faster to load than the text formats they come
+ * from (e.g. a TSPLIB instance, whose distances need not be computed again).
+ * The file holds the magic "MAGICGS1", then the arcs in compressed rows
+ * (offsets, heads and weights) and the coordinates, if any, as vectors of
+ * binary_io.h (hence files are not portable across architectures). Arcs are
+ * restored in the same order
+ */
+bool save_snapshot(AdjacencyList<>*, const char*);
+
+// the graph in the file (0 on I/O errors or invalid files)
+AdjacencyList<>* graph_from_snapshot(const char*);
+
+#endif /* __SNAPSHOT_H__ */
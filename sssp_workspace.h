@@ -0,0 +1,195 @@
+#ifndef __SSSP_WORKSPACE_H__
+#define __SSSP_WORKSPACE_H__
+
+#include <vector>
+#include <cfloat>   // for DBL_MAX
+#include <algorithm>
+#include "heap.h"
+
+/**
+ * sssp_workspace: per-thread state of a single-source search (estimates,
+ * predecessors, settled flags and the priority queue). Arrays are sized once
+ * for the graph and reset() only clears the entries touched by the previous
+ * search, so repeated searches which stop early cost what they visit rather
+ * than O(n) each. A workspace must not be shared by concurrent searches.
+ */
+class sssp_workspace
+{
+public:
+    sssp_workspace(unsigned long num_vertices)
+    : distance(num_vertices+1, DBL_MAX),
+      predecessor(num_vertices+1, 0),
+      settled(num_vertices+1, false),
+      marked(num_vertices+1, false),
+      queue(num_vertices)
+    {
+        vertex_count = num_vertices;
+    }
+
+    /* clears the previous search (only what it has touched) */
+    void reset()
+    {
+        for (unsigned long i = 0; i<touched.size(); ++i)
+        {
+            unsigned long v = touched[i];
+            distance[v] = DBL_MAX;
+            predecessor[v] = 0;
+            settled[v] = false;
+        }
+
+        touched.clear();
+        settled_order.clear();
+        queue.clear();
+    }
+
+    /* seeds a search origin (several may be given for multi-source searches) */
+    void add_source(unsigned long s, double d = 0)
+    {
+        relax(s, d, 0, d);
+    }
+
+    /* relaxation step: if 'd' improves the estimate of 'v', record it with
+     * predecessor 'pred' and (re)insert 'v' in the queue with priority 'key'
+     */
+    bool relax(unsigned long v, double d, unsigned long pred, double key)
+    {
+        if (d >= distance[v])
+            return false;
+
+        if (distance[v] == DBL_MAX)
+            touched.push_back(v);
+
+        distance[v] = d;
+        predecessor[v] = pred;
+        queue.push(v, key);
+        return true;
+    }
+
+    bool relax(unsigned long v, double d, unsigned long pred)
+    {
+        return relax(v, d, pred, d);
+    }
+
+    /* searches which order vertices by other means than the queue record
+     * estimates with update() (which, unlike relax(), queues nothing) and final
+     * distances with settle()
+     */
+    bool update(unsigned long v, double d, unsigned long pred)
+    {
+        if (d >= distance[v])
+            return false;
+
+        if (distance[v] == DBL_MAX)
+            touched.push_back(v);
+
+        distance[v] = d;
+        predecessor[v] = pred;
+        return true;
+    }
+
+    void settle(unsigned long v)
+    {
+        settled[v] = true;
+        settled_order.push_back(v);
+    }
+
+    void settle(unsigned long v, double d, unsigned long pred)
+    {
+        if (distance[v] == DBL_MAX)
+            touched.push_back(v);
+
+        distance[v] = d;
+        predecessor[v] = pred;
+        settle(v);
+    }
+
+    bool has_next() const
+    {
+        return !queue.empty();
+    }
+
+    /* priority of the next vertex to be settled */
+    double next_key() const
+    {
+        return queue.min_key();
+    }
+
+    unsigned long settle_next()
+    {
+        unsigned long v = queue.extract_min();
+        settled[v] = true;
+        settled_order.push_back(v);
+        return v;
+    }
+
+    // structure access (get)
+
+    unsigned long get_vertex_count() const
+    {
+        return vertex_count;
+    }
+
+    /* DBL_MAX if 'v' was not reached */
+    double get_distance(unsigned long v) const
+    {
+        return distance[v];
+    }
+
+    /* 0 for sources and unreached vertices */
+    unsigned long get_predecessor(unsigned long v) const
+    {
+        return predecessor[v];
+    }
+
+    /* settled vertices have final distances; others hold upper bounds */
+    bool is_settled(unsigned long v) const
+    {
+        return settled[v];
+    }
+
+    /* settled vertices, by nondecreasing distance */
+    const std::vector<unsigned long>& get_settled() const
+    {
+        return settled_order;
+    }
+
+    /* every vertex with a finite estimate */
+    const std::vector<unsigned long>& get_touched() const
+    {
+        return touched;
+    }
+
+    /* path from its source to 'v' (empty if 'v' was not reached) */
+    void get_path(unsigned long v, std::vector<unsigned long> *path) const
+    {
+        path->clear();
+        if (distance[v] == DBL_MAX)
+            return;
+
+        for (unsigned long u = v; u != 0; u = predecessor[u])
+            path->push_back(u);
+
+        std::reverse(path->begin(), path->end());
+    }
+
+    /* general purpose flags (e.g. targets of a search): whoever sets them is
+     * responsible for clearing them, since reset() does not
+     */
+    void mark(unsigned long v) { marked[v] = true; }
+    void unmark(unsigned long v) { marked[v] = false; }
+    bool is_marked(unsigned long v) const { return marked[v]; }
+
+private:
+    unsigned long vertex_count;
+
+    std::vector<double> distance;
+    std::vector<unsigned long> predecessor;
+    std::vector<bool> settled;
+    std::vector<bool> marked;
+
+    std::vector<unsigned long> touched;
+    std::vector<unsigned long> settled_order;
+    vertex_heap queue;
+};
+
+#endif /* __SSSP_WORKSPACE_H__ */
@@ -0,0 +1,70 @@
+#ifndef __TEST_UTIL_H__
+#define __TEST_UTIL_H__
+
+#include <iostream>
+#include <cstdlib>
+#include "types.h"
+
+/* graphs and checks shared by the *_test programs; graphs are seeded alike,
+ * so each test sees the same instance from run to run
+ */
+
+// 'degree' random arcs out of every vertex, with weights in [0..range]
+inline AdjacencyList<>* randomGraph(unsigned long num_vertices, unsigned long degree, unsigned long range)
+{
+    AdjacencyList<> *g = new AdjacencyList<>(num_vertices);
+
+    srand(1234567);
+
+    for (unsigned long i=1; i<=num_vertices; ++i)
+    {
+        for (unsigned long k=0; k<degree; ++k)
+        {
+            unsigned long j = (rand() % num_vertices) + 1;
+            unsigned long w = rand() % (range+1);   // edge weight w in [0..range]
+            g->addEdge(i, j, w);
+        }
+    }
+
+    return g;
+}
+
+/* random undirected graph (both arcs of each edge) with weights in
+ * [1..range+1], connected through the path 1, 2, ..., num_vertices
+ */
+inline AdjacencyList<>* randomUndirectedGraph(unsigned long num_vertices, unsigned long degree, unsigned long range)
+{
+    AdjacencyList<> *g = new AdjacencyList<>(num_vertices);
+
+    srand(1234567);
+
+    for (unsigned long i=1; i<=num_vertices; ++i)
+    {
+        for (unsigned long k=0; k<degree; ++k)
+        {
+            unsigned long j = (rand() % num_vertices) + 1;
+            unsigned long w = rand() % (range+1) + 1;   // edge weight w in [1..range+1]
+            g->addEdge(i, j, w);
+            g->addEdge(j, i, w);
+        }
+
+        if (i > 1)
+        {
+            g->addEdge(i-1, i, range+1);
+            g->addEdge(i, i-1, range+1);
+        }
+    }
+
+    return g;
+}
+
+// reports a failed check, returning 1 to be summed into the error count
+inline int check(bool condition, const char *what)
+{
+    if (!condition)
+        std::cout << "FAILED: " << what << std::endl;
+
+    return condition ? 0 : 1;
+}
+
+#endif /* __TEST_UTIL_H__ */
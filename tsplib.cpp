@@ -0,0 +1,86 @@
+#include "tsplib.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+AdjacencyList<>* graph_from_tsplib(const char * filename)
+{
+    // cities coordinates vectors
+    vector<float> xcoord;
+    vector<float> ycoord;
+    xcoord.clear();
+    ycoord.clear();
+	
+    // input file handler
+    ifstream input_fh(filename);
+
+    if (input_fh.is_open())
+    {
+        string line;
+
+        // skips file until the string preciding the first coordinates is found 
+        getline(input_fh, line);
+        while(line.find("NODE_COORD_SECTION") == string::npos)
+        {
+            getline(input_fh, line);
+            //cout << line << endl;
+        }
+
+        // parse each line, until 'end of file' is found
+        getline(input_fh, line);
+        while(line.find("EOF") == string::npos)
+        {
+            float x, y;
+            
+            // reads current coordinates, ignoring the city index
+            sscanf(line.c_str(), "%*d %f %f", &x, &y);
+            
+            xcoord.push_back(x);
+            ycoord.push_back(y);
+            
+            getline(input_fh, line);
+        }
+
+        input_fh.close();
+    }
+    else
+    {
+        cerr << "ERROR: Could not open file (might not exist)." << endl;
+        return(0);
+    }
+
+    //cout << "completed reading tsplib file" << endl;
+    //cout << "# cities: " << xcoord.size() << endl;
+
+    // creates graph corresponding to this TSP instance
+    unsigned long num_vertices = xcoord.size();
+    AdjacencyList<> *graph = new AdjacencyList<>(num_vertices);
+
+    // in the case of constructing a sparse graph
+    //srand (time(0));
+
+    for (unsigned int i = 0; i<num_vertices; ++i)
+    {
+        for (unsigned int j = 0; j<num_vertices; ++j)
+        {
+            // euclidean distance between cities i and j
+            double xd = xcoord[i] - xcoord[j];
+            double yd = ycoord[i] - ycoord[j];
+            double dij = floor( sqrt(pow(xd,2)+pow(yd,2)) + 0.5 );
+
+            // inserts an arc joining i and j, with weight = dij
+            //if ((rand() % 100) < 10)      // sparsity: 10% of the edges only
+            graph->addEdge(i+1, j+1, dij);
+        }
+
+        // keep coordinates for goal-directed searches
+        graph->set_coordinates(i+1, xcoord[i], ycoord[i]);
+    }
+
+    return graph;
+}
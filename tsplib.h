@@ -0,0 +1,11 @@
+#ifndef __TSPLIB_H__
+#define __TSPLIB_H__
+
+#include "types.h"
+
+/* reads a TSPLIB (EUC_2D) instance as a complete graph, weighting each arc by
+ * the rounded euclidean distance and keeping the cities coordinates
+ */
+AdjacencyList<>* graph_from_tsplib(const char*);
+
+#endif /* __TSPLIB_H__ */
@@ -6,6 +6,7 @@
 
 Edge::Edge(Vertex *v, double w, Edge *e)
 {
+    origin = 0;
     successor = v;
     weight = w;
     link = e;
@@ -21,7 +22,14 @@ Vertex* Edge::get_origin() const { return origin; }
 
 double Edge::get_weight() const { return weight; }
 
-void Edge::set_weight(double w) { weight = w; }
+void Edge::set_weight(double w)
+{
+    weight = w;
+
+    // outdates the properties cached on the graph
+    if (origin && origin->weight_counter)
+        __atomic_add_fetch(origin->weight_counter, 1, __ATOMIC_RELEASE);
+}
 
 /*
  * Vertex implementation
@@ -32,6 +40,7 @@ Vertex::Vertex(unsigned long k)
     key = k;
     indegree = outdegree = 0;
     adjacencies = 0;
+    weight_counter = 0;
 }
 
 
@@ -113,3 +122,31 @@ unsigned long Vertex::get_indegree() const { return indegree; }
 unsigned long Vertex::get_outdegree() const { return outdegree; }
 
 Edge* Vertex::get_adjacencies() const { return adjacencies; }
+
+void Vertex::set_weight_counter(unsigned long *counter) { weight_counter = counter; }
+
+
+/*
+ * Graph transposition
+ */
+
+AdjacencyList<>* transpose(AdjacencyList<> *graph)
+{
+    unsigned long num_vertices = graph->get_vertex_count();
+    AdjacencyList<> *reverse = new AdjacencyList<>(num_vertices);
+
+    for (unsigned long u = 1; u<=num_vertices; ++u)
+    {
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            reverse->addEdge(it->get_successor()->get_key(), u, it->get_weight());
+            it = it->get_next();
+        }
+
+        if (graph->has_coordinates())
+            reverse->set_coordinates(u, graph->get_x(u), graph->get_y(u));
+    }
+
+    return reverse;
+}
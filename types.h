@@ -66,10 +66,18 @@ public:
     virtual unsigned long get_outdegree() const;
     virtual Edge* get_adjacencies() const;
 
+    /* counter of the graph holding the vertex, bumped by Edge::set_weight()
+     * on its arcs (0: none)
+     */
+    virtual void set_weight_counter(unsigned long*);
+
 private:
     unsigned long key;
     unsigned long indegree, outdegree;
     Edge *adjacencies;
+    unsigned long *weight_counter;
+
+    friend class Edge;
 };
 
 
@@ -93,6 +101,21 @@ private:
 };
 
 
+/* weights and structure of a graph, as found by analyze_graph() */
+typedef struct {
+    unsigned long arc_count;
+    double min_weight, max_weight;   // 0 if there are no arcs
+    bool nonnegative;
+    bool integer;                    // every weight integral
+    bool uniform;                    // every arc weighs the same
+    bool zero_one;                   // weights in {0, 1}
+    bool symmetric;                  // each arc u->v has a reverse v->u of the same weight
+    bool acyclic;
+    vector<unsigned long> topological_order;   // of acyclic graphs (empty otherwise)
+    vector<unsigned long> topological_rank;    // position in it, indexed 1..n
+} graph_properties;
+
+
 /**
  * AdjacencyList: graph representation through an adjacency list. The template
  * parameters allow to use specific vertex and/or edge implementations, but is
@@ -107,11 +130,15 @@ public:
     {
         vertex_count = 0;
         vertices.push_back(0);  // dummy node
+        properties_known = false;
+        weight_changes = 0;
     }
 
     AdjacencyList(unsigned long num_vertices)
     {
         vertices.push_back(0);  // dummy node
+        properties_known = false;
+        weight_changes = 0;
 
         if (num_vertices<=0)
             vertex_count = 0;
@@ -121,6 +148,7 @@ public:
             for (unsigned long i=1; i<=vertex_count; ++i)
             {
                 V *v = new V(i);
+                v->set_weight_counter(&weight_changes);
                 vertices.push_back(v);
             }
         }
@@ -144,13 +172,22 @@ public:
         if (num_vertices<=0)
             return;
 
+        forget_properties();
         for (unsigned long i=1; i<=num_vertices; ++i)
         {
             V *v = new V(vertex_count+i);
+            v->set_weight_counter(&weight_changes);
             vertices.push_back(v);
         }
 
         vertex_count += num_vertices;
+
+        // new vertices are placed at the origin, if coordinates are kept
+        if (!xcoord.empty())
+        {
+            xcoord.resize(vertex_count+1, 0);
+            ycoord.resize(vertex_count+1, 0);
+        }
     }
 
     virtual void addEdge(unsigned long from, unsigned long to, double weight)
@@ -162,6 +199,7 @@ public:
         if (to>vertex_count)
             throw NoSuchVertexException(to);
 
+        forget_properties();
         vertices[from]->addEdge(vertices[to], weight);
     }
 
@@ -188,6 +226,7 @@ public:
         if (to>vertex_count)
             throw NoSuchVertexException(to);
 
+         forget_properties();
          return vertices[from]->removeEdge(vertices[to]);
     }
 
@@ -204,8 +243,10 @@ public:
             return false;
 
         // remove vertex: delete object, erase vector position and adjust counter
+        forget_properties();
         delete vertices[key];
         vertices.erase(vertices.begin()+key);
+        erase_coordinates(key);
         --vertex_count;
         return true;
     }
@@ -218,6 +259,7 @@ public:
             throw NoSuchVertexException(key);
 
         // remove arcs from all vertices to the specified one
+        forget_properties();
         V *v = vertices[key];
         for (unsigned long u = 1; u<=vertex_count; ++u)
             vertices[u]->removeEdge(v);
@@ -225,6 +267,7 @@ public:
         // remove vertex: delete object, erase vector position and adjust counter
         delete vertices[key];
         vertices.erase(vertices.begin()+key);
+        erase_coordinates(key);
         --vertex_count;
     }
 
@@ -243,9 +286,98 @@ public:
         return vertices[v];
     }
 
+    /* coordinates are optional (e.g. kept from TSPLIB instances), allowing
+     * goal-directed searches to use geometric lower bounds; setting the first
+     * one places every other vertex at the origin
+     */
+    virtual void set_coordinates(unsigned long v, double x, double y)
+    throw (NoSuchVertexException)
+    {
+        if (v>vertex_count)
+            throw NoSuchVertexException(v);
+
+        if (xcoord.empty())
+        {
+            xcoord.assign(vertex_count+1, 0);
+            ycoord.assign(vertex_count+1, 0);
+        }
+
+        xcoord[v] = x;
+        ycoord[v] = y;
+    }
+
+    virtual bool has_coordinates() const
+    {
+        return !xcoord.empty();
+    }
+
+    virtual double get_x(unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        if (v>vertex_count)
+            throw NoSuchVertexException(v);
+
+        return xcoord.empty() ? 0 : xcoord[v];
+    }
+
+    virtual double get_y(unsigned long v) const
+    throw (NoSuchVertexException)
+    {
+        if (v>vertex_count)
+            throw NoSuchVertexException(v);
+
+        return ycoord.empty() ? 0 : ycoord[v];
+    }
+
+    /* properties cached by analyze_graph(), 0 if unknown. Changes made through
+     * the graph forget them, and so does Edge::set_weight() on its arcs: the
+     * properties are kept along with the count of weight changes they saw.
+     * The flag is published with release/acquire, so a thread seeing it set
+     * also sees the properties
+     */
+    virtual const graph_properties* get_properties() const
+    {
+        if (!__atomic_load_n(&properties_known, __ATOMIC_ACQUIRE))
+            return 0;
+
+        return properties_changes == __atomic_load_n(&weight_changes, __ATOMIC_ACQUIRE) ? &properties : 0;
+    }
+
+    virtual void set_properties(const graph_properties &p)
+    {
+        properties = p;
+        properties_changes = __atomic_load_n(&weight_changes, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&properties_known, true, __ATOMIC_RELEASE);
+    }
+
+    virtual void forget_properties()
+    {
+        if (__atomic_load_n(&properties_known, __ATOMIC_ACQUIRE))
+        {
+            __atomic_store_n(&properties_known, false, __ATOMIC_RELEASE);
+            properties = graph_properties();
+        }
+    }
+
 protected:
+    void erase_coordinates(unsigned long key)
+    {
+        if (!xcoord.empty())
+        {
+            xcoord.erase(xcoord.begin()+key);
+            ycoord.erase(ycoord.begin()+key);
+        }
+    }
+
     vector<V*> vertices;
     unsigned long vertex_count;
+
+    // vertex coordinates (empty when the graph is not geometric)
+    vector<double> xcoord, ycoord;
+
+    graph_properties properties;
+    bool properties_known;
+    unsigned long weight_changes, properties_changes;   // by Edge::set_weight(), and when analyzed
 };
 
 
@@ -308,9 +440,11 @@ public:
         }
 
         // remove vertex: delete object, erase vector position and adjust counter
+        forget_properties();
         uvertices.erase(key);
         delete vertices[key];
         vertices.erase(vertices.begin()+key);
+        erase_coordinates(key);
         --vertex_count;
     }
     
@@ -421,4 +555,9 @@ AdjacencyList<>* adapter(vector< pair<long,double> > *adjacencies, unsigned long
     return graph;
 }
 
+/* builds a new graph with every arc of the given one reversed (coordinates are
+ * kept), e.g. to compute distances toward a vertex with single-source searches
+ */
+AdjacencyList<>* transpose(AdjacencyList<>*);
+
 #endif /* __TYPES_H__ */
@@ -0,0 +1,342 @@
+#include "voronoi.h"
+#include "analysis.h"
+#include <omp.h>
+#include <cfloat>    // for DBL_MAX
+#include <cmath>     // for floor
+#include <cstdlib>   // for atof
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include "magical_config.h"
+
+#define ulong unsigned long
+#define MAX_BUCKETS 1024   // live buckets of delta-stepping, bounding delta from below
+
+using namespace std;
+
+// whether label (d, s) beats the one of vertex v: nearer, or as near from a smaller key
+static inline bool better(double d, ulong s, const voronoi_diagram *result, ulong v)
+{
+    return d < result->distance[v] || (d == result->distance[v] && s < result->region[v]);
+}
+
+// checks the weights and clears the result; throws for sources not in the graph
+static bool prepare(AdjacencyList<> *graph, const vector<ulong> &sources, voronoi_diagram *result)
+{
+    for (ulong k = 0; k<sources.size(); ++k)
+        graph->get_vertex(sources[k]);   // throws NoSuchVertexException
+
+    if (!analyze_graph(graph).nonnegative)
+    {
+        cerr << "[magical] graph given to voronoi has negative weights." << endl;
+        return false;
+    }
+
+    ulong num_vertices = graph->get_vertex_count();
+    result->region.assign(num_vertices+1, 0);
+    result->distance.assign(num_vertices+1, DBL_MAX);
+    result->predecessor.assign(num_vertices+1, 0);
+    result->boundary.clear();
+
+    return true;
+}
+
+// arcs whose ends lie in different regions, gathered per thread
+static void region_boundary(AdjacencyList<> *graph, voronoi_diagram *result)
+{
+    long num_vertices = graph->get_vertex_count();
+    vector<pair<ulong, ulong> > &boundary = result->boundary;
+
+    #pragma omp parallel default(none) shared(graph, result, num_vertices, boundary)
+    {
+        vector<pair<ulong, ulong> > local;
+
+        #pragma omp for schedule(dynamic, 256) nowait
+        for (long u = 1; u <= num_vertices; ++u)
+        {
+            ulong ru = result->region[u];
+            if (ru == 0)
+                continue;
+
+            Edge* it = graph->get_vertex(u)->get_adjacencies();
+            while (it)
+            {
+                ulong v = it->get_successor()->get_key();
+                if (result->region[v] != ru && result->region[v] != 0)
+                    local.push_back(make_pair((ulong) u, v));
+
+                it = it->get_next();   // next edge
+            }
+        }
+
+        #pragma omp critical(region_boundary)
+        boundary.insert(boundary.end(), local.begin(), local.end());
+    }
+
+    sort(boundary.begin(), boundary.end());
+}
+
+/*
+ * Multi-source Dijkstra
+ */
+
+bool voronoi(AdjacencyList<> *graph, const vector<ulong> &sources, voronoi_diagram *result)
+{
+    if (!prepare(graph, sources, result))
+        return false;
+
+    // openmp setup (for the boundary)
+    if ( !magical_config::load_settings("voronoi", graph->get_vertex_count()) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    // entries ((distance, source), vertex), stale ones skipped
+    typedef pair<pair<double, ulong>, ulong> entry;
+    priority_queue<entry, vector<entry>, greater<entry> > queue;
+
+    // every source at distance zero, labelled with itself
+    for (ulong k = 0; k<sources.size(); ++k)
+    {
+        ulong s = sources[k];
+        if (result->region[s] == s)
+            continue;   // listed twice
+
+        result->distance[s] = 0;
+        result->region[s] = s;
+        queue.push(make_pair(make_pair(0.0, s), s));
+    }
+
+    while (!queue.empty())
+    {
+        entry e = queue.top();
+        queue.pop();
+
+        ulong u = e.second;
+        double du = e.first.first;
+        ulong ru = e.first.second;
+        if (du != result->distance[u] || ru != result->region[u])
+            continue;   // stale entry
+
+        Edge* it = graph->get_vertex(u)->get_adjacencies();
+        while (it)
+        {
+            ulong v = it->get_successor()->get_key();
+            double d = du + it->get_weight();
+
+            if (better(d, ru, result, v))
+            {
+                result->distance[v] = d;
+                result->region[v] = ru;
+                result->predecessor[v] = u;
+                queue.push(make_pair(make_pair(d, ru), v));
+            }
+
+            it = it->get_next();   // next edge
+        }
+    }
+
+    region_boundary(graph, result);
+    return true;
+}
+
+/*
+ * Parallel delta-stepping
+ */
+
+// state shared by the threads of a delta-stepping run
+typedef struct {
+    AdjacencyList<> *graph;
+    voronoi_diagram *result;
+    double delta;
+    vector<omp_lock_t> locks;                          // one per vertex, over its label
+    vector<vector<pair<ulong, ulong> > > requests;     // per thread: (bucket, vertex) relabelled
+} stepping_state;
+
+static inline ulong bucket_of(double d, double delta)
+{
+    return (ulong) floor(d / delta);
+}
+
+/* relaxes the light (or heavy) arcs of u, recording the relabelled heads in
+ * the requests of the calling thread
+ */
+static void relax_arcs(stepping_state &state, ulong u, bool light)
+{
+    voronoi_diagram *result = state.result;
+    vector<pair<ulong, ulong> > &local = state.requests[omp_get_thread_num()];
+
+    // the label of u may be improving meanwhile: read it whole
+    omp_set_lock(&state.locks[u]);
+    double du = result->distance[u];
+    ulong ru = result->region[u];
+    omp_unset_lock(&state.locks[u]);
+
+    Edge* it = state.graph->get_vertex(u)->get_adjacencies();
+    while (it)
+    {
+        double w = it->get_weight();
+        if ((w <= state.delta) == light)
+        {
+            ulong v = it->get_successor()->get_key();
+            double d = du + w;
+
+            omp_set_lock(&state.locks[v]);
+            if (better(d, ru, result, v))
+            {
+                result->distance[v] = d;
+                result->region[v] = ru;
+                result->predecessor[v] = u;
+                local.push_back(make_pair(bucket_of(d, state.delta), v));
+            }
+            omp_unset_lock(&state.locks[v]);
+        }
+
+        it = it->get_next();   // next edge
+    }
+}
+
+// relaxes the arcs of every vertex in the list, in parallel
+static void relax_all(stepping_state &state, const vector<ulong> &vertices, bool light)
+{
+    long size = vertices.size();
+
+    #pragma omp parallel for default(none) shared(state, vertices, size, light) schedule(dynamic, 64)
+    for (long k = 0; k < size; ++k)
+        relax_arcs(state, vertices[k], light);
+}
+
+/* moves the requests of every thread into their buckets, kept cyclically:
+ * bucket b at b % buckets.size(). Returns the number of requests moved
+ */
+static ulong merge_requests(stepping_state &state, vector<vector<ulong> > &buckets)
+{
+    ulong moved = 0;
+    for (ulong t = 0; t<state.requests.size(); ++t)
+    {
+        vector<pair<ulong, ulong> > &local = state.requests[t];
+        for (ulong k = 0; k<local.size(); ++k)
+            buckets[local[k].first % buckets.size()].push_back(local[k].second);
+
+        moved += local.size();
+        local.clear();
+    }
+
+    return moved;
+}
+
+bool voronoi_delta_stepping(AdjacencyList<> *graph, const vector<ulong> &sources, voronoi_diagram *result,
+    double delta)
+{
+    if (!prepare(graph, sources, result))
+        return false;
+
+    ulong num_vertices = graph->get_vertex_count();
+
+    // openmp setup
+    if ( !magical_config::load_settings("voronoi", num_vertices) )
+    {
+        std::cout << "Could not load settings from magical_config."
+            << "Using default values." << endl;
+
+        omp_set_num_threads(omp_get_num_procs());
+    }
+
+    if (delta <= 0)
+    {
+        string setting = magical_config::get_setting("voronoi", "delta");
+        delta = setting.empty() ? 0 : atof(setting.c_str());
+    }
+    const graph_properties &p = analyze_graph(graph);
+    if (delta <= 0)
+    {
+        // about one light arc relaxed per vertex and bucket
+        delta = p.arc_count ? p.max_weight * num_vertices / p.arc_count : 0;
+        if (delta <= 0)
+            delta = 1;   // zero weights only: a single bucket
+    }
+    delta = max(delta, p.max_weight / (MAX_BUCKETS - 2));
+
+    /* labels set from bucket i fall in buckets i to i + max_weight/delta + 1,
+     * so that many buckets, reused cyclically, hold every pending one
+     */
+    ulong num_buckets = (ulong) floor(p.max_weight / delta) + 2;
+
+    stepping_state state;
+    state.graph = graph;
+    state.result = result;
+    state.delta = delta;
+    state.locks.resize(num_vertices+1);
+    for (ulong v = 1; v<=num_vertices; ++v)
+        omp_init_lock(&state.locks[v]);
+    state.requests.resize(omp_get_max_threads());
+
+    vector<vector<ulong> > buckets(num_buckets);
+    ulong pending = 0;   // entries in the buckets, stale ones included
+    for (ulong k = 0; k<sources.size(); ++k)
+    {
+        ulong s = sources[k];
+        if (result->region[s] == s)
+            continue;   // listed twice
+
+        result->distance[s] = 0;
+        result->region[s] = s;
+        buckets[0].push_back(s);
+        ++pending;
+    }
+
+    // a vertex enters a round and the settled list of its bucket once
+    vector<ulong> round_stamp(num_vertices+1, 0), bucket_stamp(num_vertices+1, 0);
+    vector<ulong> frontier, settled;
+    ulong round = 0;
+
+    for (ulong i = 0; pending > 0; ++i)
+    {
+        vector<ulong> &bucket = buckets[i % num_buckets];
+        settled.clear();
+
+        // light arcs until the bucket stays empty
+        while (!bucket.empty())
+        {
+            ++round;
+            frontier.clear();
+
+            for (ulong k = 0; k<bucket.size(); ++k)
+            {
+                ulong v = bucket[k];
+
+                // stale: relabelled into a later bucket, or already in the round
+                if (bucket_of(result->distance[v], delta) != i || round_stamp[v] == round)
+                    continue;
+
+                round_stamp[v] = round;
+                frontier.push_back(v);
+
+                if (bucket_stamp[v] != i+1)
+                {
+                    bucket_stamp[v] = i+1;
+                    settled.push_back(v);
+                }
+            }
+            pending -= bucket.size();
+            bucket.clear();
+
+            relax_all(state, frontier, true);
+            pending += merge_requests(state, buckets);
+        }
+
+        // heavy arcs once, from final labels: they lead to later buckets
+        relax_all(state, settled, false);
+        pending += merge_requests(state, buckets);
+    }
+
+    for (ulong v = 1; v<=num_vertices; ++v)
+        omp_destroy_lock(&state.locks[v]);
+
+    region_boundary(graph, result);
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef __VORONOI_H__
+#define __VORONOI_H__
+
+#include <vector>
+#include <utility>
+#include "types.h"
+
+/**
+ * Graph Voronoi partition: every vertex is assigned to its nearest source
+ * (e.g. the facility serving it) by a single multi-source search in which all
+ * the sources start at distance zero, instead of a search per source and
+ * per-vertex minima. Labels are compared as (distance, source key) pairs, so
+ * a vertex equally far from several sources goes to the smallest key and the
+ * partition does not depend on the search order. Weights must be
+ * nonnegative.
+ */
+typedef struct {
+    std::vector<unsigned long> region;        // nearest source, 0 if unreachable
+    std::vector<double> distance;             // to it, DBL_MAX if unreachable
+    std::vector<unsigned long> predecessor;   // on a shortest path from it, 0 at sources
+
+    // arcs (u,v) joining two regions, sorted (both ways on undirected graphs)
+    std::vector<std::pair<unsigned long, unsigned long> > boundary;
+} voronoi_diagram;
+
+/* multi-source dijkstra, arrays indexed by vertex key (size n+1). Returns
+ * false if some weight is negative
+ */
+bool voronoi(AdjacencyList<>*, const std::vector<unsigned long>&, voronoi_diagram*);
+
+/* the same partition by parallel delta-stepping (Meyer and Sanders, 2003):
+ * tentative distances fall into buckets of width delta, the lightest
+ * nonempty bucket is emptied by relaxing the arcs of its vertices in
+ * parallel, light arcs (weight at most delta) until no label in it changes,
+ * then heavy ones once. A delta of 0 takes the one of voronoi in
+ * magical_config, or else the largest weight over the mean out-degree. Delta
+ * is raised if the buckets within the largest weight would exceed 1024
+ */
+bool voronoi_delta_stepping(AdjacencyList<>*, const std::vector<unsigned long>&, voronoi_diagram*,
+    double = 0);
+
+#endif /* __VORONOI_H__ */
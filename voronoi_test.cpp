@@ -0,0 +1,141 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <omp.h>
+#include "types.h"
+#include "paths.h"
+#include "voronoi.h"
+#include "test_util.h"
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+
+// a partition against per-vertex minima of searches from every source
+int check_partition(AdjacencyList<> *g, const voronoi_diagram &d,
+    const vector<double> &best, const vector<unsigned long> &nearest)
+{
+    unsigned long n = g->get_vertex_count();
+    int errors = 0;
+
+    for (unsigned long v = 1; v<=n; ++v)
+    {
+        errors += check(d.distance[v] == best[v], "distance to the nearest source");
+        errors += check(d.region[v] == nearest[v], "nearest source");
+
+        // predecessors: a tight arc within the region
+        unsigned long p = d.predecessor[v];
+        if (p != 0)
+        {
+            bool tight = false;
+            for (Edge* e = g->get_vertex(p)->get_adjacencies(); e; e = e->get_next())
+                tight = tight || (e->get_successor()->get_key() == v && d.distance[p] + e->get_weight() == d.distance[v]);
+            errors += check(tight && d.region[p] == d.region[v], "predecessor");
+        }
+        else
+            errors += check(d.distance[v] == 0 || d.distance[v] == DBL_MAX, "predecessor of a reached vertex");
+    }
+
+    // boundary: every arc between two regions, once
+    unsigned long count = 0;
+    for (unsigned long u = 1; u<=n; ++u)
+        for (Edge* e = g->get_vertex(u)->get_adjacencies(); e; e = e->get_next())
+        {
+            unsigned long v = e->get_successor()->get_key();
+            count += nearest[u] != 0 && nearest[v] != 0 && nearest[u] != nearest[v];
+        }
+    errors += check(d.boundary.size() == count, "boundary size");
+
+    for (unsigned long k = 0; k<d.boundary.size(); ++k)
+    {
+        unsigned long u = d.boundary[k].first, v = d.boundary[k].second;
+        errors += check(d.region[u] != d.region[v] && d.region[u] != 0 && d.region[v] != 0, "boundary arc");
+        errors += check(k == 0 || !(d.boundary[k] < d.boundary[k-1]), "sorted boundary");
+    }
+
+    return errors;
+}
+
+// -----------------------------------------------------------------------------
+
+int main()
+{
+    int errors = 0;
+    unsigned long n = 20000;
+
+    // zero weights included, so ties across them matter
+    AdjacencyList<> *g = randomGraph(n, 5, 100);
+
+    vector<unsigned long> sources;
+    for (unsigned long k = 0; k<64; ++k)
+        sources.push_back((rand() % n) + 1);
+    sources.push_back(sources[0]);   // listed twice
+
+    // per-facility searches: the nearest source, the smallest key among ties
+    double start = omp_get_wtime();
+    vector<double> best(n+1, DBL_MAX);
+    vector<unsigned long> nearest(n+1, 0);
+    sssp_workspace ws(n);
+
+    for (unsigned long k = 0; k<sources.size(); ++k)
+    {
+        unsigned long s = sources[k];
+        dijkstra(g, s, &ws);
+
+        for (unsigned long v = 1; v<=n; ++v)
+        {
+            double dv = ws.get_distance(v);
+            if (dv < best[v] || (dv == best[v] && dv < DBL_MAX && s < nearest[v]))
+            {
+                best[v] = dv;
+                nearest[v] = s;
+            }
+        }
+    }
+    double per_source_time = omp_get_wtime() - start;
+
+    voronoi_diagram d;
+    start = omp_get_wtime();
+    errors += check(voronoi(g, sources, &d), "voronoi");
+    double sweep_time = omp_get_wtime() - start;
+    errors += check_partition(g, d, best, nearest);
+
+    start = omp_get_wtime();
+    errors += check(voronoi_delta_stepping(g, sources, &d), "delta-stepping");
+    double stepping_time = omp_get_wtime() - start;
+    errors += check_partition(g, d, best, nearest);
+
+    // narrow and wide buckets give the same partition
+    errors += check(voronoi_delta_stepping(g, sources, &d, 3), "narrow buckets");
+    errors += check_partition(g, d, best, nearest);
+    errors += check(voronoi_delta_stepping(g, sources, &d, 1000), "wide buckets");
+    errors += check_partition(g, d, best, nearest);
+    errors += check(voronoi_delta_stepping(g, sources, &d, 1e-9), "delta raised to the bucket limit");
+    errors += check_partition(g, d, best, nearest);
+
+    cout << sources.size() << " sources: per-source dijkstra " << per_source_time << "s, multi-source "
+        << sweep_time << "s, delta-stepping " << stepping_time << "s" << endl;
+
+    // no sources: nothing reached
+    errors += check(voronoi(g, vector<unsigned long>(), &d) && d.region[1] == 0 && d.distance[1] == DBL_MAX
+        && d.boundary.empty(), "no sources");
+
+    // negative weights are refused
+    g->addEdge(1, 2, -1);
+    errors += check(!voronoi(g, sources, &d) && !voronoi_delta_stepping(g, sources, &d), "negative weights");
+
+    // unknown sources throw
+    bool thrown = false;
+    try {
+        voronoi(g, vector<unsigned long>(1, n+1), &d);
+    } catch (NoSuchVertexException&) {
+        thrown = true;
+    }
+    errors += check(thrown, "unknown source");
+
+    delete g;
+
+    cout << errors << " errors" << endl;
+    return errors;
+}